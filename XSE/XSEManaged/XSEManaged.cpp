@@ -121,6 +121,47 @@ namespace XSEManaged
 		}
 	}
 
+	void XSoundEngine::UpdateStorage(System::String^ strDir, System::String^ strStorage)
+	{
+		pin_ptr<const wchar_t> pStorageFile = PtrToStringChars(strStorage);
+		pin_ptr<const wchar_t> pDirectory = PtrToStringChars(strDir);
+
+		if (XSEUpdateStorage(pDirectory, pStorageFile))
+		{
+			ThrowLastError();
+		}
+	}
+
+	void XSoundEngine::CompactStorage(System::String^ strStorage)
+	{
+		pin_ptr<const wchar_t> pStorageFile = PtrToStringChars(strStorage);
+
+		if (XSECompactStorage(pStorageFile))
+		{
+			ThrowLastError();
+		}
+	}
+
+	void XSoundEngine::MountStorage(System::String^ strStorage, int nPriority)
+	{
+		pin_ptr<const wchar_t> pStorageFile = PtrToStringChars(strStorage);
+
+		if (XSEMountStorage(pStorageFile, nPriority))
+		{
+			ThrowLastError();
+		}
+	}
+
+	void XSoundEngine::UnmountStorage(System::String^ strStorage)
+	{
+		pin_ptr<const wchar_t> pStorageFile = PtrToStringChars(strStorage);
+
+		if (XSEUnmountStorage(pStorageFile))
+		{
+			ThrowLastError();
+		}
+	}
+
 	bool XSoundEngine::COMInitializer(bool bInit)
 	{
 		int nResult = XSECOMInitializer(bInit);
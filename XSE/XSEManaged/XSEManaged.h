@@ -24,6 +24,10 @@ using XSE_INIT = struct
 };
 
 _declspec(dllimport) int XSECreateStorage(const wchar_t* pDir, const wchar_t* pStorage);
+_declspec(dllimport) int XSEUpdateStorage(const wchar_t* pDir, const wchar_t* pStorage);
+_declspec(dllimport) int XSECompactStorage(const wchar_t* pStorage);
+_declspec(dllimport) int XSEMountStorage(const wchar_t* pStorage, int32_t nPriority);
+_declspec(dllimport) int XSEUnmountStorage(const wchar_t* pStorage);
 _declspec(dllimport) wchar_t* XSEGetLastError();
 _declspec(dllimport) int XSEGetLastErrorInfo(wchar_t* pBuffer, int nSize);
 _declspec(dllimport) int XSEInit(const XSE_INIT params);
@@ -78,6 +82,16 @@ namespace XSEManaged
 
 		static void CreateStorage(System::String^ strDir, System::String^ strStorage);
 
+		//     (   )   . 
+		//    .
+		static void UpdateStorage(System::String^ strDir, System::String^ strStorage);
+		static void CompactStorage(System::String^ strStorage);
+
+		//   (, )  ;    
+		//   ,   -- 0.
+		static void MountStorage(System::String^ strStorage, int nPriority);
+		static void UnmountStorage(System::String^ strStorage);
+
 		static bool COMInitializer(bool bInit);
 
 	private:
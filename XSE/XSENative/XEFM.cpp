@@ -1,45 +1,17 @@
 #include "pch.h"
 #include "XEFM.h"
+#include "XEFMFormat.h"
+#include "XEFMReader.h"
 #include "XException.h"
 
+#include <algorithm>
+
 std::unique_ptr<XEFM> XEFM::m_upCurrent{ nullptr };
 std::mutex            XEFM::m_StaticLock;
 
-//  :
-using XEFMHeaderType = struct XEFM_HEADER
-{
-	char     Label[5];   // 'EFILE'
-	uint8_t  VerHi;      // 2
-	uint8_t  VerLo;      // 2
-	uint32_t NumEntries; //   
-	uint32_t DataSize;   //    
-
-	XEFM_HEADER(uint32_t entries, uint32_t size)
-	{
-		char s[6] = "EFILE";
-
-		std::copy(s, s + 5, Label);
-		VerHi = 2;
-		VerLo = 2;
-		NumEntries = entries;
-		DataSize = size;
-	}
-
-	bool IsValid()
-	{
-		//    .
-		if ( (strncmp(Label, "EFILE", 5)) || (VerHi != 2) || (VerLo != 2))
-		{
-			return false;
-		}
-
-		return true;
-	}
-};
-
 XEFM::XEFM()
 {
-	m_bAssigned = false;
+	m_nMountOrder = 0;
 	m_bExtendedMode = false;
 }
 
@@ -56,292 +28,793 @@ XEFM& XEFM::Current()
 }
 
 void XEFM::CreateStorage(const wchar_t* pDir, const wchar_t* pStorage)
+{
+	CreateStorage(pDir, pStorage, XEFMPackSettings());
+}
+
+void XEFM::CreateStorage(const wchar_t* pDir, const wchar_t* pStorage, const XEFMPackSettings& settings)
 {
 	std::unique_lock lock{ m_StaticLock };
 
-	// :    FAT,    -, :
-	using FileEntry = std::tuple<std::wstring, std::wstring, uint32_t, uint32_t>;
+	try
+	{
+		XEFMPacker packer{ settings };
 
-	if (!std::filesystem::path(pDir).is_absolute())
+		packer.Pack(pDir, pStorage);
+	}
+	catch (const XException& e)
 	{
-		//    .
-		throw XException(L"XEFM::CreateStorage(): invalid path '%s' (must be absolute)", pDir);
+		throw XException(e, L"XEFM::CreateStorage(): can't create storage '%s'", pStorage);
 	}
+}
 
-	std::filesystem::current_path(pDir);
+void XEFM::UpdateStorage(const wchar_t* pDir, const wchar_t* pStorage)
+{
+	UpdateStorage(pDir, pStorage, XEFMPackSettings());
+}
 
-	const std::wstring strRootPath = std::filesystem::current_path();
+void XEFM::UpdateStorage(const wchar_t* pDir, const wchar_t* pStorage, const XEFMPackSettings& settings)
+{
+	std::unique_lock lock{ m_StaticLock };
 
 	try
 	{
-		std::filesystem::recursive_directory_iterator dir_it{ std::filesystem::path{strRootPath} };
-   		std::list<FileEntry>                          listFiles;
-		
-		std::wstring strFilePath;
-		std::wstring strFileMapName;
-		uint32_t     nFileSize{ 0 };
-		uint32_t     nFileOffset{ sizeof(XEFMHeaderType) };
-		uint32_t     nTotalSize{ 0 };
-
-		//     .     .
-		for (const auto& e : dir_it)
+		if (IsInUse(pStorage))
 		{
-			if (e.is_regular_file())
-			{
-				//   ,  .
-				strFilePath = e.path().c_str();
+			throw XException(L"XEFM::UpdateStorage(): storage file '%s' is in use", pStorage);
+		}
 
-				if (strFilePath.find(strRootPath) != 0)
-				{
-					throw XException(L"XEFM::CreateStorage(): unable to process file '%s'", strFilePath.c_str());
-				}
+		std::shared_ptr<MountedStorage> spMount = LoadStorage(pStorage);
+		std::vector<XEFMDirectoryEntry> vecEntries;
 
-				//       :
-				strFileMapName = strFilePath;
-				strFileMapName.replace(strFileMapName.begin(), strFileMapName.begin() + strRootPath.length(), L"");
-				
-				//   :
-				nFileSize = (uint32_t)std::filesystem::file_size(e.path());
-
-				//  :
-				listFiles.emplace_back(strFilePath, strFileMapName, nFileOffset, nFileSize);
-				
-				//  :
-				nFileOffset += nFileSize;
-				nTotalSize += nFileSize;
-			}
-		}
+		spMount->Directory.GetEntries(0, vecEntries);
 
-		//     .
-		std::ofstream stgFile{ pStorage, std::ios::out | std::ios::binary |std::ios::trunc };
+		//   ,     .
+		std::shared_ptr<const XEFMMapping> spStorage = std::move(spMount->spStorage);
 
-		if (!stgFile.is_open())
-		{
-			throw XException(L"XEFM::CreateStorage(): can't create storage file '%s'", pStorage);
-		}
+		spMount.reset();
 
-		stgFile.unsetf(std::ios::skipws);
+		XEFMPacker packer{ settings };
+
+		packer.Update(pDir, pStorage, std::move(spStorage), vecEntries);
+	}
+	catch (const XException& e)
+	{
+		throw XException(e, L"XEFM::UpdateStorage(): can't update storage '%s'", pStorage);
+	}
+}
 
-		//  .
-		XEFMHeaderType header{(uint32_t)listFiles.size(), nTotalSize };
+void XEFM::CompactStorage(const wchar_t* pStorage)
+{
+	CompactStorage(pStorage, XEFMPackSettings());
+}
 
-		auto x = sizeof(XEFMHeaderType);
+void XEFM::CompactStorage(const wchar_t* pStorage, const XEFMPackSettings& settings)
+{
+	std::unique_lock lock{ m_StaticLock };
 
-		stgFile.write(reinterpret_cast<char*>(&header), sizeof(XEFMHeaderType));
+	//       ,     .
+	const std::wstring strNewStorage = std::wstring(pStorage) + L".compact";
 
-		//   ( ).
-		for (const auto& f : listFiles)
+	try
+	{
+		if (IsInUse(pStorage))
 		{
-			std::ifstream srcFile{ std::get<0>(f), std::ios::binary |std::ios::in};
+			throw XException(L"XEFM::CompactStorage(): storage file '%s' is in use", pStorage);
+		}
 
-			if (!srcFile.is_open())
-			{
-				throw XException(L"XEFM::CreateStorage(): can't open source file 's'", std::get<0>(f));
-			}
+		{
+			std::shared_ptr<MountedStorage> spMount = LoadStorage(pStorage);
+			std::vector<XEFMDirectoryEntry> vecEntries;
 
-			srcFile.unsetf(std::ios::skipws);
+			spMount->Directory.GetEntries(0, vecEntries);
 
-			for(char d;;)
-			{
-				srcFile >> d;
+			XEFMPacker packer{ settings };
 
-				if (srcFile.eof())
-					break;
-				
-				stgFile << d;
-			}
-    	}
+			packer.Compact(*spMount->spStorage, vecEntries, strNewStorage.c_str());
+		}
 
-		//         -  (,   ).
-		for (const auto& f : listFiles)
-		{
-			strFileMapName = std::get<1>(f);
-			nFileOffset = std::get<2>(f);
-			nFileSize = std::get<3>(f);
+		std::error_code ec;
 
-			auto store_string = [&stgFile](const std::wstring& s)
-			{
-				wchar_t send = '\0';
+		std::filesystem::rename(strNewStorage, pStorage, ec);
 
-				for (size_t i = 0; i < s.size(); ++i)
-				{
-					//   :
-					auto c = s[i];
+		if (ec)
+		{
+			throw XException(L"XEFM::CompactStorage(): can't replace storage file '%s'", pStorage);
+		}
+	}
+	catch (const XException& e)
+	{
+		std::error_code ec;
 
-					stgFile.write(reinterpret_cast<char*>(&c), sizeof(wchar_t));
-				}
+		std::filesystem::remove(strNewStorage, ec);
 
-				// NULL  :
-				stgFile.write(reinterpret_cast<char*>(&send), sizeof(wchar_t));
-			};
+		throw XException(e, L"XEFM::CompactStorage(): can't compact storage '%s'", pStorage);
+	}
+}
 
-			store_string(strFileMapName);
-			stgFile.write(reinterpret_cast<char*>(&nFileOffset), sizeof(uint32_t));
-			stgFile.write(reinterpret_cast<char*>(&nFileSize), sizeof(uint32_t));
-		};
+bool XEFM::IsInUse(const wchar_t* pStorageFile)
+{
+	std::shared_ptr<const Namespace> spNamespace = (m_upCurrent) ? std::atomic_load(&m_upCurrent->m_spNamespace) : nullptr;
 
+	if (!spNamespace)
+	{
+		return false;
 	}
-	catch (const std::exception& e)
+
+	for (const auto& spMounted : spNamespace->Mounts)
 	{
-		UNREFERENCED_PARAMETER(e);
+		std::error_code ec;
 
-		throw XException(L"XEFM::CreateStorage(): internal error");
+		if (std::filesystem::equivalent(spMounted->strFileName, pStorageFile, ec))
+		{
+			return true;
+		}
 	}
 
-	// .
+	return false;
 }
 
 void XEFM::AssignFile(const wchar_t* pStorageFile)
 {
 	std::unique_lock lock{ m_Lock };
 
-	if (m_bAssigned)
+	if (std::atomic_load(&m_spNamespace))
 	{
 		//     .
 		throw XException(L"XEFM::AssignFile(): Storage file is already assigned");
 	}
 
-	std::ifstream stgFile{ pStorageFile, std::ios::in | std::ios::binary };
+	std::shared_ptr<MountedStorage> spMount;
+
+	try
+	{
+		spMount = LoadStorage(pStorageFile);
+	}
+	catch (const XException& e)
+	{
+		throw XException(e, L"XEFM::AssignFile(): can't assign file '%s'", pStorageFile);
+	}
+
+	// OK.
+
+	spMount->nPriority = 0;
+	spMount->nOrder = m_nMountOrder++;
+	spMount->bBase = true;
+
+	std::wstring strStoragePath = spMount->strFileName.substr(0, spMount->strFileName.find_last_of('\\') + 1);
+
+	//         ,    .
+	std::filesystem::current_path(strStoragePath);
+	strStoragePath = std::filesystem::current_path();
+
+	m_Overlay.Assign(strStoragePath);
+
+	Publish(strStoragePath, { spMount });
+}
+
+void XEFM::Mount(const wchar_t* pStorageFile, int32_t nPriority)
+{
+	std::unique_lock lock{ m_Lock };
+
+	std::shared_ptr<const Namespace> spNamespace = std::atomic_load(&m_spNamespace);
+
+	if (!spNamespace)
+	{
+		throw XException(L"XEFM::Mount(): Storage file is not assigned");
+	}
+
+	for (const auto& spMounted : spNamespace->Mounts)
+	{
+		if (spMounted->strFileName == pStorageFile)
+		{
+			throw XException(L"XEFM::Mount(): storage file '%s' is already mounted", pStorageFile);
+		}
+	}
+
+	std::shared_ptr<MountedStorage> spMount;
 
-	if (!stgFile.is_open())
+	try
+	{
+		spMount = LoadStorage(pStorageFile);
+	}
+	catch (const XException& e)
+	{
+		throw XException(e, L"XEFM::Mount(): can't mount file '%s'", pStorageFile);
+	}
+
+	spMount->nPriority = nPriority;
+	spMount->nOrder = m_nMountOrder++;
+	spMount->bBase = false;
+
+	std::vector<std::shared_ptr<const MountedStorage>> vecMounts = spNamespace->Mounts;
+
+	vecMounts.push_back(std::move(spMount));
+
+	Publish(spNamespace->strStoragePath, std::move(vecMounts));
+}
+
+void XEFM::Unmount(const wchar_t* pStorageFile)
+{
+	std::unique_lock lock{ m_Lock };
+
+	std::shared_ptr<const Namespace> spNamespace = std::atomic_load(&m_spNamespace);
+
+	if (!spNamespace)
+	{
+		throw XException(L"XEFM::Unmount(): Storage file is not assigned");
+	}
+
+	std::vector<std::shared_ptr<const MountedStorage>> vecMounts;
+	bool bFound{ false };
+
+	for (const auto& spMounted : spNamespace->Mounts)
+	{
+		if (spMounted->strFileName != pStorageFile)
+		{
+			vecMounts.push_back(spMounted);
+		}
+		else if (spMounted->bBase)
+		{
+			//  .
+			throw XException(L"XEFM::Unmount(): storage file '%s' is assigned, not mounted", pStorageFile);
+		}
+		else
+		{
+			bFound = true;
+		}
+	}
+
+	if (!bFound)
+	{
+		throw XException(L"XEFM::Unmount(): storage file '%s' is not mounted", pStorageFile);
+	}
+
+	Publish(spNamespace->strStoragePath, std::move(vecMounts));
+}
+
+std::shared_ptr<XEFM::MountedStorage> XEFM::LoadStorage(const wchar_t* pStorageFile)
+{
+	auto spMount = std::make_shared<MountedStorage>();
+
+	spMount->strFileName = pStorageFile;
+
+	//      ,     .
+	try
+	{
+		spMount->spStorage = std::make_shared<const XEFMMapping>(pStorageFile);
+	}
+	catch (const XException& e)
 	{
 		//   .
-		throw XException(L"XEFM::AssignFile(): can't open file '%s'", pStorageFile);
+		throw XException(e, L"XEFM::LoadStorage(): can't open file '%s'", pStorageFile);
 	}
 
-	//  :
+	const XEFMMapping& storage = *spMount->spStorage;
+
+	//   (   --     ):
 	XEFMHeaderType header{ 0, 0 };
 
-	stgFile.read(reinterpret_cast<char*>(&header), sizeof(XEFMHeaderType));
+	if (storage.GetSize() < sizeof(XEFMHeaderType))
+	{
+		throw XException(L"XEFM::LoadStorage(): unsupported file type, header is not valid");
+	}
+
+	memcpy(&header, storage.GetData(), sizeof(XEFMHeaderType));
 
-	if (!header.IsValid())
+	if (header.IsValid())
+	{
+		LoadDirectory2(storage, pStorageFile, spMount->Directory);
+	}
+	else if ((header.HasLabel()) && (header.VerHi == 3) && (header.VerLo <= 2))
+	{
+		LoadDirectory3(storage, pStorageFile, spMount->Directory);
+	}
+	else
 	{
 		//  .
-		throw XException(L"XEFM::AssignFile(): unsupported file type, header is not valid");
+		throw XException(L"XEFM::LoadStorage(): unsupported file type, header is not valid");
 	}
 
-	//   ,    :
-	stgFile.seekg(header.DataSize + sizeof(XEFMHeaderType));
+	return spMount;
+}
 
-	for (uint32_t i = 0; i < header.NumEntries; ++i)
+void XEFM::Publish(const std::wstring& strStoragePath, std::vector<std::shared_ptr<const MountedStorage>> mounts)
+{
+	//   ,   --   .
+	std::sort(mounts.begin(), mounts.end(), [](const auto& sp1, const auto& sp2)
 	{
-		auto load_string = [&stgFile](std::wstring& s)
+		return (sp1->nPriority != sp2->nPriority) ? (sp1->nPriority > sp2->nPriority) : (sp1->nOrder > sp2->nOrder);
+	});
+
+	auto spNamespace = std::make_shared<Namespace>();
+
+	spNamespace->strStoragePath = strStoragePath;
+	spNamespace->Mounts = std::move(mounts);
+	spNamespace->pDirectory = &spNamespace->Mounts.front()->Directory;
+
+	if (spNamespace->Mounts.size() > 1)
+	{
+		//  :     ( ) ,   .
+		//            .
+		std::vector<XEFMDirectoryEntry> vecEntries;
+		std::vector<XEFMDirectoryEntry> vecStorageEntries;
+		XEFMFileInfo info;
+
+		for (uint32_t i = 0; i < (uint32_t)spNamespace->Mounts.size(); ++i)
 		{
-			auto               old_pos = stgFile.tellg();
-			wchar_t            c;
-			uint32_t           l{ 0 };
+			vecStorageEntries.clear();
+			spNamespace->Mounts[i]->Directory.GetEntries(i, vecStorageEntries);
 
-			do
+			for (auto& entry : vecStorageEntries)
 			{
-				//     '\0'.
-				stgFile.read(reinterpret_cast<char*>(&c), sizeof(wchar_t));
-				l++;
-			} while (c != '\0');
+				bool bHidden{ false };
+
+				for (uint32_t j = 0; (j < i) && (!bHidden); ++j)
+				{
+					bHidden = spNamespace->Mounts[j]->Directory.FindEntry(entry.strName, info);
+				}
+
+				if ((!bHidden) && (!(entry.nFlags & XEFM_ENTRY_DELETED)))
+				{
+					vecEntries.push_back(std::move(entry));
+				}
+			}
+		}
 
-			//      .
-			stgFile.seekg(old_pos);
+		spNamespace->Directory.Assign(vecEntries);
+		spNamespace->pDirectory = &spNamespace->Directory;
+	}
 
-			std::unique_ptr<wchar_t[]> spBuffer{ new wchar_t[l] };
-			stgFile.read(reinterpret_cast<char*>(spBuffer.get()), l * sizeof(wchar_t));
+	std::atomic_store(&m_spNamespace, std::shared_ptr<const Namespace>(std::move(spNamespace)));
+}
 
-			s.assign(spBuffer.get(), spBuffer.get() + l - 1);
-		};
+void XEFM::LoadDirectory2(const XEFMMapping& storage, const wchar_t* pStorageFile, XEFMDirectory& directory)
+{
+	const std::byte* pData = storage.GetData();
+	const uint64_t   nStorageSize = storage.GetSize();
+
+	XEFMHeaderType header{ 0, 0 };
+
+	memcpy(&header, pData, sizeof(XEFMHeaderType));
+
+	//   --  ,    :
+	uint64_t nPos = (uint64_t)header.DataSize + sizeof(XEFMHeaderType);
+
+	auto corrupted = [pStorageFile]()
+	{
+		return XException(L"XEFM::LoadDirectory2(): storage file '%s' is corrupted", pStorageFile);
+	};
+
+	std::vector<XEFMDirectoryEntry> vecEntries(header.NumEntries);
+	std::wstring strFileMapName;
 
-		std::wstring strFileMapName;
-		uint32_t     nFileOffset, nFileSize;
+	for (auto& entry : vecEntries)
+	{
+		//  --  wchar_t  '\0' (   ).
+		uint64_t nNameEnd = nPos;
+
+		for (wchar_t c{ 1 }; c != '\0'; nNameEnd += sizeof(wchar_t))
+		{
+			if (nNameEnd + sizeof(wchar_t) > nStorageSize)
+			{
+				throw corrupted();
+			}
+
+			memcpy(&c, pData + nNameEnd, sizeof(wchar_t));
+		}
+
+		if (nNameEnd + 2 * sizeof(uint32_t) > nStorageSize)
+		{
+			throw corrupted();
+		}
 
 		//  :
+		uint32_t nFileOffset, nFileSize;
+
+		strFileMapName.resize((size_t)(nNameEnd - nPos) / sizeof(wchar_t) - 1);
+
+		memcpy(strFileMapName.data(), pData + nPos, strFileMapName.size() * sizeof(wchar_t));
+		memcpy(&nFileOffset, pData + nNameEnd, sizeof(uint32_t));
+		memcpy(&nFileSize, pData + nNameEnd + sizeof(uint32_t), sizeof(uint32_t));
 
-		load_string(strFileMapName);
-		stgFile.read(reinterpret_cast<char*>(&nFileOffset), sizeof(uint32_t));
-		stgFile.read(reinterpret_cast<char*>(&nFileSize), sizeof(uint32_t));
+		nPos = nNameEnd + 2 * sizeof(uint32_t);
+		entry.nOffset = nFileOffset;
+		entry.nSize = nFileSize;
+
+		if (entry.nOffset + entry.nSize > nStorageSize)
+		{
+			throw corrupted();
+		}
 
-		//   -:
-		
-		m_FileMap[strFileMapName] = std::pair(nFileOffset, nFileSize);
+		XEFMDirectory::ToUTF8(strFileMapName, entry.strName);
 	}
 
-	// OK.
+	//    3.1   .
+	directory.Assign(vecEntries);
+}
 
-	m_bAssigned = true;
-	m_StorageFileName = pStorageFile;
-	m_StoragePath = m_StorageFileName.substr(0, m_StorageFileName.find_last_of('\\') + 1);
+void XEFM::LoadDirectory3(const XEFMMapping& storage, const wchar_t* pStorageFile, XEFMDirectory& directory)
+{
+	XEFMHeader3Type header{ 0, 0, 0, 0 };
 
-	//         ,    .
-	std::filesystem::current_path(m_StoragePath);
-	m_StoragePath = std::filesystem::current_path();
+	if (storage.GetSize() < sizeof(XEFMHeader3Type))
+	{
+		throw XException(L"XEFM::LoadDirectory3(): storage file '%s' is corrupted", pStorageFile);
+	}
+
+	memcpy(&header, storage.GetData(), sizeof(XEFMHeader3Type));
+
+	if (header.VerLo == 2)
+	{
+		// 3.2:    --    .
+		XEFMHeader32Type header32{ 0, 0, 0, 0, 0 };
+
+		if (storage.GetSize() < sizeof(XEFMHeader32Type))
+		{
+			throw XException(L"XEFM::LoadDirectory3(): storage file '%s' is corrupted", pStorageFile);
+		}
+
+		memcpy(&header32, storage.GetData(), sizeof(XEFMHeader32Type));
+
+		if ((header32.DirectoryOffset < sizeof(XEFMHeader32Type)) || (header32.DirectoryOffset % 8) ||
+			(header32.DirectoryOffset > storage.GetSize()) || (header32.DirectorySize > storage.GetSize() - header32.DirectoryOffset) ||
+			(!directory.Attach(storage.GetData() + header32.DirectoryOffset, header32.DirectorySize, header32.NumEntries, header32.NumBuckets, storage.GetSize())))
+		{
+			throw XException(L"XEFM::LoadDirectory3(): storage file '%s' is corrupted", pStorageFile);
+		}
+
+		return;
+	}
+
+	if ((header.DataSize > storage.GetSize()) || (sizeof(XEFMHeader3Type) + (uint64_t)header.DirectorySize > storage.GetSize() - header.DataSize))
+	{
+		throw XException(L"XEFM::LoadDirectory3(): storage file '%s' is corrupted", pStorageFile);
+	}
+
+	const std::byte* pBlock = storage.GetData() + sizeof(XEFMHeader3Type);
+
+	if (header.VerLo == 1)
+	{
+		// 3.1:     .
+		if (!directory.Attach(pBlock, header.DirectorySize, header.NumEntries, header.NumBuckets, storage.GetSize()))
+		{
+			throw XException(L"XEFM::LoadDirectory3(): storage file '%s' is corrupted", pStorageFile);
+		}
+
+		return;
+	}
+
+	// 3.0: 32-    ,    3.1   .
+	const uint64_t nEntriesOffset = (header.NumBuckets + 1ull) * sizeof(uint32_t);
+	const uint64_t nNamesOffset = nEntriesOffset + (uint64_t)header.NumEntries * sizeof(XEFMEntry30Type);
+
+	if (nNamesOffset > header.DirectorySize)
+	{
+		throw XException(L"XEFM::LoadDirectory3(): storage file '%s' is corrupted", pStorageFile);
+	}
+
+	std::vector<XEFMDirectoryEntry> vecEntries(header.NumEntries);
+
+	for (uint32_t i = 0; i < header.NumEntries; ++i)
+	{
+		XEFMEntry30Type e;
+
+		memcpy(&e, pBlock + nEntriesOffset + i * sizeof(XEFMEntry30Type), sizeof(XEFMEntry30Type));
+
+		if (((uint64_t)e.NameOffset + e.NameLength > header.DirectorySize - nNamesOffset) ||
+			((uint64_t)e.Offset + e.Size > storage.GetSize()))
+		{
+			throw XException(L"XEFM::LoadDirectory3(): storage file '%s' is corrupted", pStorageFile);
+		}
+
+		vecEntries[i].strName.assign(reinterpret_cast<const char*>(pBlock + nNamesOffset + e.NameOffset), e.NameLength);
+		vecEntries[i].nOffset = e.Offset;
+		vecEntries[i].nSize = e.Size;
+	}
+
+	directory.Assign(vecEntries);
 }
 
 void XEFM::SetExtendedMode(bool mode)
 {
-	std::unique_lock lock{ m_Lock };
-
 	m_bExtendedMode = mode;
 }
 
 void XEFM::Reset()
 {
-	if (!m_bAssigned)
+	std::unique_lock lock{ m_Lock };
+
+	if (!std::atomic_load(&m_spNamespace))
 	{
 		//  ,  .
 		return;
 	}
 
-	m_FileMap.clear();
-	m_bAssigned = false;
+	//       .
+	std::atomic_store(&m_spNamespace, std::shared_ptr<const Namespace>());
+
+	m_Overlay.Reset();
 	m_bExtendedMode = false;
 }
 
+void XEFM::RefreshOverlay()
+{
+	m_Overlay.Refresh();
+}
+
+std::future<void> XEFM::Prefetch(const std::vector<std::wstring>& names)
+{
+	std::vector<XEFMPrefetchRange> vecRanges;
+
+	for (const auto& strName : names)
+	{
+		std::shared_ptr<const XEFMMapping> spMapping;
+		XEFMFileInfo info{ 0, 0, 0, 0 };
+
+		try
+		{
+			GetReaderInfo(strName.c_str(), spMapping, info);
+		}
+		catch (const XException& e)
+		{
+			throw XException(e, L"XEFM::Prefetch(): can't prefetch file '%s'", strName.c_str());
+		}
+
+		GetPrefetchRanges(spMapping, info, 0, UINT64_MAX, vecRanges);
+	}
+
+	return m_Prefetcher.Add(std::move(vecRanges));
+}
 
-void XEFM::GetReaderInfo(const wchar_t* pFileName, std::wstring& strContainer, uint32_t& nStartPos, uint32_t& nEndPos) const
+std::future<void> XEFM::PrefetchRange(const wchar_t* pFileName, uint64_t nOffset, uint64_t nSize)
 {
-	std::shared_lock lock{ m_Lock };
+	std::shared_ptr<const XEFMMapping> spMapping;
+	XEFMFileInfo info{ 0, 0, 0, 0 };
+
+	try
+	{
+		GetReaderInfo(pFileName, spMapping, info);
+	}
+	catch (const XException& e)
+	{
+		throw XException(e, L"XEFM::PrefetchRange(): can't prefetch file '%s'", pFileName);
+	}
+
+	std::vector<XEFMPrefetchRange> vecRanges;
 
-	if (!m_bAssigned)
+	GetPrefetchRanges(spMapping, info, nOffset, nSize, vecRanges);
+
+	return m_Prefetcher.Add(std::move(vecRanges));
+}
+
+void XEFM::GetPrefetchRanges(const std::shared_ptr<const XEFMMapping>& spMapping, const XEFMFileInfo& info,
+	uint64_t nOffset, uint64_t nSize, std::vector<XEFMPrefetchRange>& ranges)
+{
+	if (!(info.nFlags & XEFM_ENTRY_LZW))
+	{
+		if (nOffset < info.nSize)
+		{
+			ranges.push_back({ spMapping, info.nOffset + nOffset, min(nSize, info.nSize - nOffset) });
+		}
+
+		return;
+	}
+
+	//  :       ,    .  
+	// ,    (  ).
+	const std::byte* pEntry = spMapping->GetData() + info.nOffset;
+	XEFMLZWIndexType index{ 0, 0, 0 };
+
+	if (info.nSize >= sizeof(XEFMLZWIndexType))
+	{
+		memcpy(&index, pEntry, sizeof(XEFMLZWIndexType));
+	}
+
+	const uint64_t nIndexSize = sizeof(XEFMLZWIndexType) + (index.NumBlocks + 1ull) * sizeof(uint64_t);
+
+	if ((!index.BlockSize) || ((index.Size + index.BlockSize - 1) / index.BlockSize != index.NumBlocks) || (nIndexSize > info.nSize))
+	{
+		ranges.push_back({ spMapping, info.nOffset, info.nSize });
+
+		return;
+	}
+
+	if ((nOffset >= index.Size) || (!nSize))
+	{
+		return;
+	}
+
+	const uint64_t nFirst = nOffset / index.BlockSize;
+	const uint64_t nLast = (nOffset + min(nSize, index.Size - nOffset) - 1) / index.BlockSize;
+	uint64_t nBegin, nEnd;
+
+	memcpy(&nBegin, pEntry + sizeof(XEFMLZWIndexType) + nFirst * sizeof(uint64_t), sizeof(uint64_t));
+	memcpy(&nEnd, pEntry + sizeof(XEFMLZWIndexType) + (nLast + 1) * sizeof(uint64_t), sizeof(uint64_t));
+
+	if ((nBegin > nEnd) || (nEnd > info.nSize))
+	{
+		nBegin = 0;
+		nEnd = info.nSize;
+	}
+
+	ranges.push_back({ spMapping, info.nOffset, nIndexSize });
+	ranges.push_back({ spMapping, info.nOffset + nBegin, nEnd - nBegin });
+}
+
+void XEFM::GetReaderInfo(const wchar_t* pFileName, std::shared_ptr<const XEFMMapping>& spMapping, XEFMFileInfo& info) const
+{
+	//  :      .
+	std::shared_ptr<const Namespace> spNamespace = std::atomic_load(&m_spNamespace);
+
+	if (!spNamespace)
 	{
 		//  .
 		throw XException(L"XEFM::GetReaderInfo(): Storage file is not assigned");
 	}
 
-	auto pos_it = m_FileMap.find(std::wstring(pFileName));
+	XEFMFileInfo fileInfo{ 0, 0, 0, 0 };
+	bool         bFound = spNamespace->pDirectory->Find(pFileName, fileInfo);
 
-	if ( (pos_it == m_FileMap.end()) && (!m_bExtendedMode))
+	if ( (!bFound) && (!m_bExtendedMode))
 	{
 		//   ,    .
 		throw XException(L"XEFM::GetReaderInfo(): File '%s' not found", pFileName);
 	}
 	
-	//      FAT:
-	std::wstring strRealName = m_StoragePath + std::wstring(pFileName);
-	bool bRealExists{ false };
-	
-	{
-		std::ifstream file{ strRealName, std::ios::in };
+	//     FAT ( ,    ):
+	std::wstring strRealName = spNamespace->strStoragePath + std::wstring(pFileName);
 
-		bRealExists = file.is_open();
-	}
-
-	if (bRealExists)
+	if (m_Overlay.Find(strRealName))
 	{
-		//    FAT,   .
-		strContainer = strRealName;
-		nStartPos = 0;
-		nEndPos = ((uint32_t)std::filesystem::file_size(strRealName)) - 1;
+		//    FAT,    ( ).
+		spMapping = std::make_shared<const XEFMMapping>(strRealName.c_str());
+		info = XEFMFileInfo{ 0, spMapping->GetSize(), 0, 0 };
 	}
 	else
 	{
-		if ((pos_it == m_FileMap.end()))
+		if (!bFound)
 		{
 			//   ,    ,      .
 			throw XException(L"XEFM::GetReaderInfo(): File '%s' not found", pFileName);
 		};
 
 		//     .
-		const auto[nFileOffset, nFileSize] = m_FileMap.at(pFileName);
+		spMapping = spNamespace->Mounts[fileInfo.nStorage]->spStorage;
+		info = fileInfo;
+	}
+}
+
+void XEFM::Benchmark(std::wostream& os, const wchar_t* pWorkDir, uint32_t nMegabytes)
+{
+	XEFM& efm = Current();
+
+	if (std::atomic_load(&efm.m_spNamespace))
+	{
+		throw XException(L"XEFM::Benchmark(): Storage file is already assigned");
+	}
+
+	const std::filesystem::path prevPath = std::filesystem::current_path();
+	const std::filesystem::path workPath = std::filesystem::path(pWorkDir) / L"efm_benchmark";
+	const std::filesystem::path srcPath = workPath / L"src";
+
+	std::filesystem::remove_all(workPath);
+	std::filesystem::create_directories(srcPath);
+
+	//   1 :      16- PCM (  ).
+	const size_t nFileSize = 1 << 20;
+	std::vector<std::wstring> vecNames;
+	std::string data;
+	uint32_t nRandom{ 12345 };
+
+	auto random = [&nRandom]()
+	{
+		nRandom = nRandom * 1103515245 + 12345;
+
+		return (nRandom >> 16) & 0x7FFF;
+	};
+
+	for (uint32_t i = 0; i < max(nMegabytes, 1u); ++i)
+	{
+		static const char* const words[] = { "sound", "bank", "file", "name", "stream", "fetch", "id", "=", "<", "/>", "\"", "wav" };
+
+		std::wstring strName = ((i & 1) ? L"pcm_" : L"text_") + std::to_wstring(i) + ((i & 1) ? L".pcm" : L".txt");
+
+		data.clear();
 
-		//  .
-		strContainer = m_StorageFileName;
-		nStartPos = nFileOffset;
-		nEndPos = nFileOffset + nFileSize - 1;
+		while (data.size() < nFileSize)
+		{
+			if (i & 1)
+			{
+				int16_t nSample = (int16_t)((int)(data.size() / 2 % 200) * 80 - 8000 + (int)(random() & 0xFF) - 128);
+
+				data.append(reinterpret_cast<const char*>(&nSample), sizeof(nSample));
+			}
+			else
+			{
+				data += words[random() % (sizeof(words) / sizeof(words[0]))];
+				data += (random() % 8) ? " " : "\r\n";
+			}
+		}
+
+		data.resize(nFileSize);
+
+		std::ofstream file{ srcPath / strName, std::ios::out | std::ios::binary | std::ios::trunc };
+
+		file.write(data.data(), data.size());
+
+		if (!file.good())
+		{
+			throw XException(L"XEFM::Benchmark(): can't write file '%s'", strName.c_str());
+		}
+
+		//    --    .
+		vecNames.push_back(L"\\" + strName);
+	}
+
+	std::vector<char> buffer(64 << 10);
+
+	try
+	{
+		for (bool bCompress : { false, true })
+		{
+			const std::wstring strStorage = (workPath / ((bCompress) ? L"lzw.efm" : L"raw.efm")).wstring();
+
+			XEFMPackSettings settings;
+
+			settings.bCompress = bCompress;
+
+			auto t0 = std::chrono::steady_clock::now();
+
+			CreateStorage(srcPath.wstring().c_str(), strStorage.c_str(), settings);
+
+			auto t1 = std::chrono::steady_clock::now();
+
+			efm.Reset();
+			efm.AssignFile(strStorage.c_str());
+
+			//      .
+			auto t2 = std::chrono::steady_clock::now();
+
+			uint64_t nRead{ 0 };
+			XEFMReader reader;
+
+			for (const auto& strName : vecNames)
+			{
+				reader.Open(strName.c_str());
+
+				for (uint32_t n; (n = reader.ReadBytes(buffer.data(), (uint32_t)buffer.size())) != 0; )
+				{
+					nRead += n;
+				}
+
+				reader.Close();
+			}
+
+			auto t3 = std::chrono::steady_clock::now();
+
+			efm.Reset();
+
+			double fPackSeconds = std::chrono::duration<double>(t1 - t0).count();
+			double fOpenSeconds = std::chrono::duration<double>(t2 - t1).count();
+			double fReadSeconds = std::chrono::duration<double>(t3 - t2).count();
+
+			os << ((bCompress) ? L"lzw" : L"raw") << L": files: " << vecNames.size()
+				<< L", storage bytes: " << std::filesystem::file_size(strStorage)
+				<< L", pack seconds: " << fPackSeconds
+				<< L", open seconds: " << fOpenSeconds
+				<< L", read MB/s: " << nRead / fReadSeconds / (1024.0 * 1024.0) << std::endl;
+		}
 	}
+	catch (const XException&)
+	{
+		efm.Reset();
+		std::filesystem::current_path(prevPath);
+		std::filesystem::remove_all(workPath);
+
+		throw;
+	}
+
+	std::filesystem::current_path(prevPath);
+	std::filesystem::remove_all(workPath);
 }
@@ -1,23 +1,64 @@
 #pragma once
 
 #include "XGlobals.h"
+#include "XEFMDirectory.h"
+#include "XEFMMapping.h"
+#include "XEFMOverlay.h"
+#include "XEFMPacker.h"
+#include "XEFMPrefetcher.h"
+
+/*
+
+   .    AssignFile(),   
+     (Mount())  :      
+   (  --  ).     
+   ,    --  -.
+
+         . 
+         :  
+   ,  ,       ( 
+    ).
+
+*/
 
 class XEFM
 {
 	friend class XEFMReader;
 private:
-	bool         m_bAssigned;        //  
-	std::wstring m_StorageFileName;
-	std::wstring m_StoragePath;
-	bool         m_bExtendedMode;
+	//  .
+	struct MountedStorage
+	{
+		std::wstring                       strFileName;
+		int32_t                            nPriority;
+		uint64_t                           nOrder;        //  
+		bool                               bBase;         //  AssignFile()
+		std::shared_ptr<const XEFMMapping> spStorage;     // ,   
+		XEFMDirectory                      Directory;
+	};
+
+	struct Namespace
+	{
+		std::wstring                                       strStoragePath;  //   
+		std::vector<std::shared_ptr<const MountedStorage>> Mounts;          //   
+		XEFMDirectory                                      Directory;       //   (nStorage --   Mounts)
+		const XEFMDirectory*                               pDirectory;      // Directory    
+	};
+
+	//    (std::atomic_load / std::atomic_store), nullptr --  .
+	std::shared_ptr<const Namespace> m_spNamespace;
+	uint64_t                         m_nMountOrder;
+	std::atomic<bool>                m_bExtendedMode;
 
-	//  :   ->   & .
-	std::unordered_map<std::wstring, std::pair<uint32_t, uint32_t>> m_FileMap;
+	//      (  ,   ).
+	XEFMOverlay m_Overlay;
+
+	//   .
+	XEFMPrefetcher m_Prefetcher;
 
 	//    .
 	static std::unique_ptr<XEFM> m_upCurrent;
 
-	//   .
+	//    (m_Lock --   ,     ).
 	mutable std::shared_mutex m_Lock;
 	static  std::mutex        m_StaticLock;
 
@@ -29,17 +70,78 @@ public:
 	//        .
 	static void CreateStorage(const wchar_t* pDir, const wchar_t* pStorage);
 
+	//  ,    (,  ,    ).
+	static void CreateStorage(const wchar_t* pDir, const wchar_t* pStorage, const XEFMPackSettings& settings);
+
+	//   (3.x)   pDir  :       ,
+	//  ,    (XEFMFormat.h).    
+	//   .
+	static void UpdateStorage(const wchar_t* pDir, const wchar_t* pStorage);
+
+	static void UpdateStorage(const wchar_t* pDir, const wchar_t* pStorage, const XEFMPackSettings& settings);
+
+	//      ,     
+	// (  3.1).       .
+	static void CompactStorage(const wchar_t* pStorage);
+
+	static void CompactStorage(const wchar_t* pStorage, const XEFMPackSettings& settings);
+
 	//   - .
 	void AssignFile(const wchar_t* pStorageFile);
 
+	//      .     0.
+	void Mount(const wchar_t* pStorageFile, int32_t nPriority);
+
+	//    (    Reset()).  
+	//    .
+	void Unmount(const wchar_t* pStorageFile);
+
 	//    (    FAT  ,    .
 	void SetExtendedMode(bool mode);
 
 	//      .
 	void Reset();
 
+	//       . ,    
+	//     (,  ).
+	void RefreshOverlay();
+
+	//     (,     ):    
+	//    ,      .    ( 
+	// -- ),  ,   .
+	std::future<void> Prefetch(const std::vector<std::wstring>& names);
+
+	//    nSize     nOffset (   -- ,    ).
+	std::future<void> PrefetchRange(const wchar_t* pFileName, uint64_t nOffset, uint64_t nSize);
+
+	//  :  pWorkDir ( )  nMegabytes   (  PCM),  
+	//       ,     XEFMReader.  os
+	//   ,  ,      ( ).
+	//     ;   .
+	static void Benchmark(std::wostream& os, const wchar_t* pWorkDir, uint32_t nMegabytes = 64);
+
 private:
-	//        .
-	void GetReaderInfo(const wchar_t* pFileName, std::wstring& strContainer, uint32_t& nStartPos, uint32_t& nEndPos) const;
+	//      .
+	static std::shared_ptr<MountedStorage> LoadStorage(const wchar_t* pStorageFile);
+
+	//     2.2 (  )  3.x (  ,  3.2 -- 
+	//   ).
+	static void LoadDirectory2(const XEFMMapping& storage, const wchar_t* pStorageFile, XEFMDirectory& directory);
+
+	static void LoadDirectory3(const XEFMMapping& storage, const wchar_t* pStorageFile, XEFMDirectory& directory);
+
+	//      ( m_StaticLock).
+	static bool IsInUse(const wchar_t* pStorageFile);
+
+	//        .
+	void Publish(const std::wstring& strStoragePath, std::vector<std::shared_ptr<const MountedStorage>> mounts);
+
+	//     nSize     nOffset.
+	static void GetPrefetchRanges(const std::shared_ptr<const XEFMMapping>& spMapping, const XEFMFileInfo& info,
+		uint64_t nOffset, uint64_t nSize, std::vector<XEFMPrefetchRange>& ranges);
+
+	//        :  ( 
+	//    FAT)     .
+	void GetReaderInfo(const wchar_t* pFileName, std::shared_ptr<const XEFMMapping>& spMapping, XEFMFileInfo& info) const;
 };
 
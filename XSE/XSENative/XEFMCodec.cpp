@@ -0,0 +1,147 @@
+#include "pch.h"
+#include "XEFMCodec.h"
+#include "XException.h"
+
+// aux::LZWCore  std::min,  windows.h   min  max.
+#pragma push_macro("min")
+#pragma push_macro("max")
+#undef min
+#undef max
+#include "../../auxCode/auxCode/auxLZWCore.h"
+#pragma pop_macro("max")
+#pragma pop_macro("min")
+
+namespace
+{
+	//   LZW (  -- 4096 ,   aux::LZWCore  ).
+	constexpr unsigned char LZW_MAX_BITS = 12;
+
+	//  : LZWCore   *it = c; it++.
+	class EncodeOutput
+	{
+	private:
+		std::vector<std::byte>* m_pDest;
+
+	public:
+		EncodeOutput(std::vector<std::byte>* pDest) : m_pDest(pDest)
+		{
+		}
+
+		EncodeOutput& operator * () { return *this; }
+
+		EncodeOutput& operator = (unsigned char c)
+		{
+			m_pDest->push_back(static_cast<std::byte>(c));
+
+			return *this;
+		}
+
+		EncodeOutput& operator ++ () { return *this; }
+
+		EncodeOutput& operator ++ (int) { return *this; }
+	};
+
+	//      .
+	class DecodeInput
+	{
+	private:
+		const unsigned char* m_p;
+		const unsigned char* m_pEnd;
+
+	public:
+		DecodeInput(const std::byte* p, size_t nSize) : m_p(reinterpret_cast<const unsigned char*>(p)), m_pEnd(m_p + nSize)
+		{
+		}
+
+		unsigned char operator * () const
+		{
+			if (m_p == m_pEnd)
+			{
+				throw XException(L"XEFMCodec::Decompress(): unexpected end of block");
+			}
+
+			return *m_p;
+		}
+
+		DecodeInput& operator ++ () { ++m_p; return *this; }
+
+		DecodeInput& operator ++ (int) { ++m_p; return *this; }
+	};
+
+	//     . LZWCore::Decode()    std::copy  
+	//    ,       .
+	struct DecodeSink
+	{
+		std::byte* pDest;
+		size_t     nSize;
+		size_t     nDone;
+	};
+
+	class DecodeOutput
+	{
+	private:
+		DecodeSink* m_pSink;
+
+	public:
+		using iterator_category = std::output_iterator_tag;
+		using value_type = void;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = void;
+
+		DecodeOutput(DecodeSink* pSink) : m_pSink(pSink)
+		{
+		}
+
+		DecodeOutput& operator * () { return *this; }
+
+		DecodeOutput& operator = (unsigned char c)
+		{
+			if (m_pSink->nDone == m_pSink->nSize)
+			{
+				throw XException(L"XEFMCodec::Decompress(): block is too large");
+			}
+
+			m_pSink->pDest[m_pSink->nDone++] = static_cast<std::byte>(c);
+
+			return *this;
+		}
+
+		DecodeOutput& operator ++ () { return *this; }
+
+		DecodeOutput& operator ++ (int) { return *this; }
+	};
+}
+
+void XEFMCodec::Compress(const std::byte* pSrc, size_t nSize, std::vector<std::byte>& dest)
+{
+	aux::LZWCore lzw;
+
+	const unsigned char* pBegin = reinterpret_cast<const unsigned char*>(pSrc);
+	const unsigned char* pEnd = pBegin + nSize;
+	EncodeOutput out{ &dest };
+
+	dest.clear();
+	dest.reserve(nSize / 2);
+
+	lzw.Init(LZW_MAX_BITS);
+	lzw.Encode(pBegin, pEnd, out);
+}
+
+void XEFMCodec::Decompress(const std::byte* pSrc, size_t nSrcSize, std::byte* pDest, size_t nSize)
+{
+	aux::LZWCore lzw;
+
+	DecodeInput  in{ pSrc, nSrcSize };
+	DecodeInput  end{ pSrc + nSrcSize, 0 };
+	DecodeSink   sink{ pDest, nSize, 0 };
+	DecodeOutput out{ &sink };
+
+	lzw.Init(LZW_MAX_BITS);
+	lzw.Decode(in, end, out);
+
+	if (sink.nDone != nSize)
+	{
+		throw XException(L"XEFMCodec::Decompress(): block is too short");
+	}
+}
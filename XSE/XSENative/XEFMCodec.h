@@ -0,0 +1,14 @@
+#pragma once
+
+#include "XGlobals.h"
+
+//     (aux::LZWCore  auxCode).
+class XEFMCodec
+{
+public:
+	//  nSize ,  --  dest ().
+	static void Compress(const std::byte* pSrc, size_t nSize, std::vector<std::byte>& dest);
+
+	//     nSize .  XException,   .
+	static void Decompress(const std::byte* pSrc, size_t nSrcSize, std::byte* pDest, size_t nSize);
+};
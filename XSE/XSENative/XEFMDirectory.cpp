@@ -0,0 +1,285 @@
+#include "pch.h"
+#include "XEFMDirectory.h"
+
+XEFMDirectory::XEFMDirectory()
+{
+	Reset();
+}
+
+void XEFMDirectory::Reset()
+{
+	static const uint32_t EmptyBuckets[2] = { 0, 0 };
+
+	m_Block.clear();
+	m_Storages.clear();
+	m_pBuckets = EmptyBuckets;
+	m_pEntries = nullptr;
+	m_pNames = nullptr;
+	m_nEntries = 0;
+	m_nBuckets = 1;
+}
+
+bool XEFMDirectory::Attach(const std::byte* pBlock, uint32_t nBlockSize, uint32_t nEntries, uint32_t nBuckets, uint64_t nStorageSize)
+{
+	//       ,   --  .
+	if ((nBuckets == 0) || (nBuckets & (nBuckets - 1)))
+	{
+		return false;
+	}
+
+	const uint64_t nTableSize = GetEntriesOffset(nBuckets) + (uint64_t)nEntries * sizeof(XEFMEntryType);
+
+	if (nTableSize > nBlockSize)
+	{
+		return false;
+	}
+
+	const uint32_t*      pBuckets = reinterpret_cast<const uint32_t*>(pBlock);
+	const XEFMEntryType* pEntries = reinterpret_cast<const XEFMEntryType*>(pBlock + GetEntriesOffset(nBuckets));
+	const uint32_t       nNamesSize = nBlockSize - (uint32_t)nTableSize;
+
+	//      :  ,    .
+	if ((pBuckets[0] != 0) || (pBuckets[nBuckets] != nEntries))
+	{
+		return false;
+	}
+
+	for (uint32_t i = 0; i < nBuckets; ++i)
+	{
+		if (pBuckets[i] > pBuckets[i + 1])
+		{
+			return false;
+		}
+
+		for (uint32_t j = pBuckets[i]; j < pBuckets[i + 1]; ++j)
+		{
+			const XEFMEntryType& e = pEntries[j];
+
+			if (((e.Hash & (nBuckets - 1)) != i) ||
+				((uint64_t)e.NameOffset + e.NameLength > nNamesSize) || (e.Flags & ~(XEFM_ENTRY_LZW | XEFM_ENTRY_DELETED)) ||
+				(e.Offset > nStorageSize) || (e.Size > nStorageSize - e.Offset))
+			{
+				return false;
+			}
+		}
+	}
+
+	m_Block.clear();
+	m_Storages.clear();
+	m_pBuckets = pBuckets;
+	m_pEntries = pEntries;
+	m_pNames = reinterpret_cast<const char*>(pBlock) + nTableSize;
+	m_nEntries = nEntries;
+	m_nBuckets = nBuckets;
+
+	return true;
+}
+
+void XEFMDirectory::Assign(const std::vector<XEFMDirectoryEntry>& entries)
+{
+	std::vector<uint32_t> vecStorages;
+	std::string block = Build(entries, &vecStorages);
+	const uint32_t nBuckets = GetBucketCount((uint32_t)entries.size());
+	const size_t nTableSize = GetEntriesOffset(nBuckets);
+
+	m_Block = std::move(block);
+	m_Storages = std::move(vecStorages);
+	m_pBuckets = reinterpret_cast<const uint32_t*>(m_Block.data());
+	m_pEntries = reinterpret_cast<const XEFMEntryType*>(m_Block.data() + nTableSize);
+	m_pNames = m_Block.data() + nTableSize + entries.size() * sizeof(XEFMEntryType);
+	m_nEntries = (uint32_t)entries.size();
+	m_nBuckets = nBuckets;
+}
+
+bool XEFMDirectory::Find(const wchar_t* pName, XEFMFileInfo& info) const
+{
+	std::string strName;
+
+	ToUTF8(pName, strName);
+
+	return Find(strName, info);
+}
+
+bool XEFMDirectory::Find(std::string_view strName, XEFMFileInfo& info) const
+{
+	return (FindEntry(strName, info)) && (!(info.nFlags & XEFM_ENTRY_DELETED));
+}
+
+bool XEFMDirectory::FindEntry(std::string_view strName, XEFMFileInfo& info) const
+{
+	const uint32_t nHash = Hash(strName);
+	const uint32_t nBucket = nHash & (m_nBuckets - 1);
+
+	for (uint32_t i = m_pBuckets[nBucket]; i < m_pBuckets[nBucket + 1]; ++i)
+	{
+		const XEFMEntryType& e = m_pEntries[i];
+
+		if ((e.Hash == nHash) && (e.NameLength == strName.size()) && (memcmp(m_pNames + e.NameOffset, strName.data(), e.NameLength) == 0))
+		{
+			info.nOffset = e.Offset;
+			info.nSize = e.Size;
+			info.nFlags = e.Flags;
+			info.nStorage = (m_Storages.empty()) ? 0 : m_Storages[i];
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void XEFMDirectory::GetEntries(uint32_t nStorage, std::vector<XEFMDirectoryEntry>& entries) const
+{
+	entries.reserve(entries.size() + m_nEntries);
+
+	for (uint32_t i = 0; i < m_nEntries; ++i)
+	{
+		const XEFMEntryType& e = m_pEntries[i];
+
+		entries.push_back({ std::string(m_pNames + e.NameOffset, e.NameLength), e.Offset, e.Size, e.Flags, nStorage });
+	}
+}
+
+uint32_t XEFMDirectory::GetBucketCount(uint32_t nEntries)
+{
+	//   :      .
+	uint32_t nBuckets{ 1 };
+
+	while ((nBuckets < nEntries) && (nBuckets < 0x80000000))
+	{
+		nBuckets <<= 1;
+	}
+
+	return nBuckets;
+}
+
+uint32_t XEFMDirectory::GetEntriesOffset(uint32_t nBuckets)
+{
+	//    8.
+	return (uint32_t)(((nBuckets + 1ull) * sizeof(uint32_t) + 7) & ~7ull);
+}
+
+uint32_t XEFMDirectory::GetBlockSize(uint32_t nEntries, size_t nNamesSize)
+{
+	size_t nSize = GetEntriesOffset(GetBucketCount(nEntries)) + nEntries * sizeof(XEFMEntryType) + nNamesSize;
+
+	return (uint32_t)((nSize + 7) & ~(size_t)7);
+}
+
+std::string XEFMDirectory::Build(const std::vector<XEFMDirectoryEntry>& entries, std::vector<uint32_t>* pStorages)
+{
+	const uint32_t nEntries = (uint32_t)entries.size();
+	const uint32_t nBuckets = GetBucketCount(nEntries);
+
+	size_t nNamesSize{ 0 };
+
+	for (const auto& e : entries)
+	{
+		nNamesSize += e.strName.size();
+	}
+
+	std::string block(GetBlockSize(nEntries, nNamesSize), '\0');
+
+	uint32_t*      pBuckets = reinterpret_cast<uint32_t*>(block.data());
+	XEFMEntryType* pEntries = reinterpret_cast<XEFMEntryType*>(block.data() + GetEntriesOffset(nBuckets));
+	char*          pNames = reinterpret_cast<char*>(pEntries + nEntries);
+
+	//    :   ,   .
+	std::vector<uint32_t> vecHashes(nEntries);
+
+	for (uint32_t i = 0; i < nEntries; ++i)
+	{
+		vecHashes[i] = Hash(entries[i].strName);
+		pBuckets[(vecHashes[i] & (nBuckets - 1)) + 1]++;
+	}
+
+	for (uint32_t i = 0; i < nBuckets; ++i)
+	{
+		pBuckets[i + 1] += pBuckets[i];
+	}
+
+	std::vector<uint32_t> vecNext(pBuckets, pBuckets + nBuckets);
+	uint32_t nNameOffset{ 0 };
+
+	if (pStorages)
+	{
+		pStorages->assign(nEntries, 0);
+	}
+
+	for (uint32_t i = 0; i < nEntries; ++i)
+	{
+		const XEFMDirectoryEntry& src = entries[i];
+		const uint32_t nPos = vecNext[vecHashes[i] & (nBuckets - 1)]++;
+		XEFMEntryType& e = pEntries[nPos];
+
+		if (pStorages)
+		{
+			(*pStorages)[nPos] = src.nStorage;
+		}
+
+		e.Hash = vecHashes[i];
+		e.NameOffset = nNameOffset;
+		e.NameLength = (uint32_t)src.strName.size();
+		e.Flags = src.nFlags;
+		e.Offset = src.nOffset;
+		e.Size = src.nSize;
+
+		memcpy(pNames + nNameOffset, src.strName.data(), src.strName.size());
+		nNameOffset += e.NameLength;
+	}
+
+	return block;
+}
+
+uint32_t XEFMDirectory::Hash(std::string_view strName)
+{
+	uint32_t nHash{ 2166136261u };
+
+	for (char c : strName)
+	{
+		nHash = (nHash ^ (uint8_t)c) * 16777619u;
+	}
+
+	return nHash;
+}
+
+void XEFMDirectory::ToUTF8(std::wstring_view strName, std::string& s)
+{
+	s.clear();
+	s.reserve(strName.size());
+
+	for (size_t i = 0; i < strName.size(); ++i)
+	{
+		uint32_t c = (uint32_t)strName[i];
+
+		//   UTF-16.
+		if ((c >= 0xD800) && (c <= 0xDBFF) && (i + 1 < strName.size()) &&
+			((uint32_t)strName[i + 1] >= 0xDC00) && ((uint32_t)strName[i + 1] <= 0xDFFF))
+		{
+			c = 0x10000 + ((c - 0xD800) << 10) + ((uint32_t)strName[++i] - 0xDC00);
+		}
+
+		if (c < 0x80)
+		{
+			s += (char)c;
+		}
+		else if (c < 0x800)
+		{
+			s += (char)(0xC0 | (c >> 6));
+			s += (char)(0x80 | (c & 0x3F));
+		}
+		else if (c < 0x10000)
+		{
+			s += (char)(0xE0 | (c >> 12));
+			s += (char)(0x80 | ((c >> 6) & 0x3F));
+			s += (char)(0x80 | (c & 0x3F));
+		}
+		else
+		{
+			s += (char)(0xF0 | (c >> 18));
+			s += (char)(0x80 | ((c >> 12) & 0x3F));
+			s += (char)(0x80 | ((c >> 6) & 0x3F));
+			s += (char)(0x80 | (c & 0x3F));
+		}
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "XGlobals.h"
+#include "XEFMFormat.h"
+
+//    .
+struct XEFMDirectoryEntry
+{
+	std::string strName;    // UTF-8
+	uint64_t    nOffset;    //   
+	uint64_t    nSize;      //  
+	uint32_t    nFlags{ 0 };
+	uint32_t    nStorage{ 0 };  //   (    )
+};
+
+//  .
+struct XEFMFileInfo
+{
+	uint64_t nOffset;
+	uint64_t nSize;
+	uint32_t nFlags;
+	uint32_t nStorage;
+};
+
+//   ( 3.1, . XEFMFormat.h): -   .  
+//     ,     ( 2.2  3.0).
+class XEFMDirectory
+{
+private:
+	std::string          m_Block;      //  ,     
+	std::vector<uint32_t> m_Storages;  //    (  ),     
+	const uint32_t*      m_pBuckets;
+	const XEFMEntryType* m_pEntries;
+	const char*          m_pNames;
+	uint32_t             m_nEntries;
+	uint32_t             m_nBuckets;
+
+public:
+	XEFMDirectory();
+
+	XEFMDirectory(const XEFMDirectory&) = delete;
+
+	XEFMDirectory& operator = (const XEFMDirectory&) = delete;
+
+	//    ( ), FALSE      
+	//  nStorageSize.   ,   .
+	bool Attach(const std::byte* pBlock, uint32_t nBlockSize, uint32_t nEntries, uint32_t nBuckets, uint64_t nStorageSize);
+
+	//     .
+	void Assign(const std::vector<XEFMDirectoryEntry>& entries);
+
+	void Reset();
+
+	uint32_t GetCount() const { return m_nEntries; }
+
+	//     (   ).
+	bool Find(const wchar_t* pName, XEFMFileInfo& info) const;
+
+	bool Find(std::string_view strName, XEFMFileInfo& info) const;
+
+	//  ,       (XEFM_ENTRY_DELETED).
+	bool FindEntry(std::string_view strName, XEFMFileInfo& info) const;
+
+	//   entries       nStorage.
+	void GetEntries(uint32_t nStorage, std::vector<XEFMDirectoryEntry>& entries) const;
+
+	//    nEntries .
+	static uint32_t GetBucketCount(uint32_t nEntries);
+
+	//      ( ).
+	static uint32_t GetEntriesOffset(uint32_t nBuckets);
+
+	//    nEntries      nNamesSize ( ).
+	static uint32_t GetBlockSize(uint32_t nEntries, size_t nNamesSize);
+
+	//    ,  -- GetBlockSize().  pStorages ( ) -- 
+	//     .
+	static std::string Build(const std::vector<XEFMDirectoryEntry>& entries, std::vector<uint32_t>* pStorages = nullptr);
+
+	static uint32_t Hash(std::string_view strName);
+
+	// UTF-16 ( UTF-32,    wchar_t) -> UTF-8.
+	static void ToUTF8(std::wstring_view strName, std::string& s);
+};
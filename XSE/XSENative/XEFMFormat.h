@@ -0,0 +1,184 @@
+#pragma once
+
+#include "XGlobals.h"
+
+//   - .
+
+//    2.2 (   ,  -- wchar_t).     
+//    ,       .
+using XEFMHeaderType = struct XEFM_HEADER
+{
+	char     Label[5];   // 'EFILE'
+	uint8_t  VerHi;      // 2
+	uint8_t  VerLo;      // 2
+	uint32_t NumEntries; //   
+	uint32_t DataSize;   //    
+
+	XEFM_HEADER(uint32_t entries, uint32_t size)
+	{
+		char s[6] = "EFILE";
+
+		std::copy(s, s + 5, Label);
+		VerHi = 2;
+		VerLo = 2;
+		NumEntries = entries;
+		DataSize = size;
+	}
+
+	bool IsValid()
+	{
+		//    .
+		if ( (!HasLabel()) || (VerHi != 2) || (VerLo != 2))
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	bool HasLabel() const
+	{
+		return strncmp(Label, "EFILE", 5) == 0;
+	}
+};
+
+/*
+
+   3.1 (3.0 --    32-   ,   ):
+
+   XEFMHeader3Type
+    (DirectorySize ,   8):
+       uint32_t        Buckets[NumBuckets + 1]   --   i: Entries[Buckets[i]] .. Entries[Buckets[i + 1] - 1]
+                                                    ( 3.1     8 )
+       XEFMEntryType   Entries[NumEntries]       --   
+       char            Names[]                   --   UTF-8,  '\0'
+     (DataSize ;       , . XEFMPackSettings)
+
+   3.2 -- 3.x,    (XEFM::UpdateStorage()):    
+   ,   --    (  8),   XEFMHeader32Type
+    .        (FlushFileBuffers())
+  ,   ,  --         .
+ ,    ,    ,    
+    .    ,       ,
+      (XEFM::CompactStorage()).      
+   XEFM_ENTRY_DELETED ( )     .
+
+   -- Hash & (NumBuckets - 1), Hash -- FNV-1a    UTF-8.   
+     ,   .
+
+    XEFM_ENTRY_LZW   (Size --   )   BlockSize ,
+     (aux::LZWCore),       :
+
+   XEFMLZWIndexType
+   uint64_t        Blocks[NumBlocks + 1]     --     ,  --  
+                                  -- ,   ,    ( 
+                                                     )
+
+*/
+
+//   3.x.  3.0   DataSize  uint32_t DataSize   uint32_t,  
+//  3.0    .
+using XEFMHeader3Type = struct XEFM_HEADER_3
+{
+	char     Label[5];       // 'EFILE'
+	uint8_t  VerHi;          // 3
+	uint8_t  VerLo;          // 1
+	uint8_t  Reserved;       // 0
+	uint32_t Flags;          // , 0
+	uint32_t NumEntries;     //   
+	uint32_t NumBuckets;     //  
+	uint32_t DirectorySize;  //  --   
+	uint64_t DataSize;       //  --   
+
+	XEFM_HEADER_3(uint32_t entries, uint32_t buckets, uint32_t dirsize, uint64_t size)
+	{
+		char s[6] = "EFILE";
+
+		std::copy(s, s + 5, Label);
+		VerHi = 3;
+		VerLo = 1;
+		Reserved = 0;
+		Flags = 0;
+		NumEntries = entries;
+		NumBuckets = buckets;
+		DirectorySize = dirsize;
+		DataSize = size;
+	}
+
+	bool IsValid() const
+	{
+		return (strncmp(Label, "EFILE", 5) == 0) && (VerHi == 3) && ((VerLo == 0) || (VerLo == 1));
+	}
+};
+
+//   3.2:  --   3.1,  --  DirectoryOffset.
+using XEFMHeader32Type = struct XEFM_HEADER_32
+{
+	char     Label[5];         // 'EFILE'
+	uint8_t  VerHi;            // 3
+	uint8_t  VerLo;            // 2
+	uint8_t  Reserved;         // 0
+	uint32_t Flags;            // , 0
+	uint32_t NumEntries;       //    ( )
+	uint32_t NumBuckets;       //  
+	uint32_t DirectorySize;
+	uint64_t DirectoryOffset;  //   ,  8
+	uint32_t Generation;       //  ,  1
+	uint32_t Reserved2;        // 0
+
+	XEFM_HEADER_32(uint32_t entries, uint32_t buckets, uint32_t dirsize, uint64_t offset, uint32_t generation)
+	{
+		char s[6] = "EFILE";
+
+		std::copy(s, s + 5, Label);
+		VerHi = 3;
+		VerLo = 2;
+		Reserved = 0;
+		Flags = 0;
+		NumEntries = entries;
+		NumBuckets = buckets;
+		DirectorySize = dirsize;
+		DirectoryOffset = offset;
+		Generation = generation;
+		Reserved2 = 0;
+	}
+
+	bool IsValid() const
+	{
+		return (strncmp(Label, "EFILE", 5) == 0) && (VerHi == 3) && (VerLo == 2);
+	}
+};
+
+//    3.1:
+using XEFMEntryType = struct XEFM_ENTRY
+{
+	uint32_t Hash;           // FNV-1a  
+	uint32_t NameOffset;     //   
+	uint32_t NameLength;     //  
+	uint32_t Flags;          // XEFM_ENTRY_...,   -- 0
+	uint64_t Offset;         //   
+	uint64_t Size;
+};
+
+//  :
+constexpr uint32_t XEFM_ENTRY_LZW = 0x1;       //  
+constexpr uint32_t XEFM_ENTRY_DELETED = 0x2;   //    (3.2), Offset  Size -- 0
+
+//     (   ):
+using XEFMLZWIndexType = struct XEFM_LZW_INDEX
+{
+	uint64_t Size;           //  
+	uint32_t BlockSize;      //    ( -- )
+	uint32_t NumBlocks;
+};
+
+//    3.0:
+using XEFMEntry30Type = struct XEFM_ENTRY_30
+{
+	uint32_t Hash;
+	uint32_t NameOffset;
+	uint32_t NameLength;
+	uint32_t Flags;
+	uint32_t Offset;
+	uint32_t Size;
+};
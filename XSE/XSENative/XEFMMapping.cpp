@@ -0,0 +1,60 @@
+#include "pch.h"
+#include "XEFMMapping.h"
+#include "XException.h"
+
+XEFMMapping::XEFMMapping(const wchar_t* pFileName)
+{
+	m_pData = nullptr;
+	m_nSize = 0;
+
+	HANDLE hFile = CreateFileW(pFileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		throw XException(L"XEFMMapping::XEFMMapping(): can't open file '%s'", pFileName);
+	}
+
+	LARGE_INTEGER nFileSize;
+
+	if (!GetFileSizeEx(hFile, &nFileSize))
+	{
+		CloseHandle(hFile);
+
+		throw XException(L"XEFMMapping::XEFMMapping(): can't get size of file '%s'", pFileName);
+	}
+
+	if (nFileSize.QuadPart == 0)
+	{
+		//    ,    .
+		CloseHandle(hFile);
+
+		return;
+	}
+
+	HANDLE hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	const void* pView = (hMapping != nullptr) ? MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+	//    ,    .
+	if (hMapping != nullptr)
+	{
+		CloseHandle(hMapping);
+	}
+
+	CloseHandle(hFile);
+
+	if (pView == nullptr)
+	{
+		throw XException(L"XEFMMapping::XEFMMapping(): can't map file '%s'", pFileName);
+	}
+
+	m_pData = static_cast<const std::byte*>(pView);
+	m_nSize = (uint64_t)nFileSize.QuadPart;
+}
+
+XEFMMapping::~XEFMMapping()
+{
+	if (m_pData != nullptr)
+	{
+		UnmapViewOfFile(m_pData);
+	}
+}
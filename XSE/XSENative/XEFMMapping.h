@@ -0,0 +1,40 @@
+#pragma once
+
+#include "XGlobals.h"
+
+//     (std::span<const std::byte>    C++20).
+struct XEFMView
+{
+	const std::byte* pData{ nullptr };
+	size_t           nSize{ 0 };
+
+	const std::byte* begin() const { return pData; }
+
+	const std::byte* end() const { return pData + nSize; }
+
+	bool empty() const { return nSize == 0; }
+};
+
+// ,       .      
+// (std::shared_ptr),   ,      ,  
+// XEFM::Reset().
+class XEFMMapping
+{
+private:
+	const std::byte* m_pData;
+	uint64_t         m_nSize;
+
+public:
+	//    : GetData() == nullptr, GetSize() == 0.
+	XEFMMapping(const wchar_t* pFileName);
+
+	~XEFMMapping();
+
+	XEFMMapping(const XEFMMapping&) = delete;
+
+	XEFMMapping& operator = (const XEFMMapping&) = delete;
+
+	const std::byte* GetData() const { return m_pData; }
+
+	uint64_t GetSize() const { return m_nSize; }
+};
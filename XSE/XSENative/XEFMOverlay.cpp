@@ -0,0 +1,144 @@
+#include "pch.h"
+#include "XEFMOverlay.h"
+
+XEFMOverlay::XEFMOverlay()
+{
+	m_hChange = INVALID_HANDLE_VALUE;
+	m_hStop = NULL;
+}
+
+XEFMOverlay::~XEFMOverlay()
+{
+	Reset();
+}
+
+std::wstring XEFMOverlay::Normalize(std::wstring_view strPath)
+{
+	std::wstring s(strPath);
+
+	for (auto& c : s)
+	{
+		c = (c == L'/') ? L'\\' : (wchar_t)std::towlower(c);
+	}
+
+	return s;
+}
+
+std::shared_ptr<const XEFMOverlay::FileSet> XEFMOverlay::Scan(const std::wstring& strRoot)
+{
+	std::shared_ptr<FileSet> spFiles = std::make_shared<FileSet>();
+
+	//   ,   --   (  , ,  
+	// ,  ).
+	std::error_code ec;
+	std::filesystem::recursive_directory_iterator it{ std::filesystem::path{strRoot}, std::filesystem::directory_options::skip_permission_denied, ec };
+
+	for (; (!ec) && (it != std::filesystem::recursive_directory_iterator()); it.increment(ec))
+	{
+		if (it->is_regular_file(ec))
+		{
+			spFiles->insert(Normalize(it->path().wstring()));
+		}
+	}
+
+	return spFiles;
+}
+
+void XEFMOverlay::ThreadWatch()
+{
+	HANDLE handles[2] = { m_hChange, m_hStop };
+
+	for (;;)
+	{
+		if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0)
+		{
+			//  (  ).
+			break;
+		}
+
+		//     ,       .
+		if (!FindNextChangeNotification(m_hChange))
+		{
+			break;
+		}
+
+		Refresh();
+	}
+}
+
+void XEFMOverlay::Assign(const std::wstring& strRoot)
+{
+	Reset();
+
+	{
+		std::lock_guard<std::mutex> lock{ m_ScanLock };
+
+		m_strRoot = strRoot;
+	}
+
+	//    ,       .
+	m_hChange = FindFirstChangeNotificationW(strRoot.c_str(), TRUE, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME);
+
+	if (m_hChange != INVALID_HANDLE_VALUE)
+	{
+		m_hStop = CreateEventW(NULL, TRUE, FALSE, NULL);
+
+		if (m_hStop != NULL)
+		{
+			m_spWatchThread.reset(new std::thread(&XEFMOverlay::ThreadWatch, this));
+		}
+		else
+		{
+			FindCloseChangeNotification(m_hChange);
+			m_hChange = INVALID_HANDLE_VALUE;
+		}
+	}
+
+	Refresh();
+}
+
+void XEFMOverlay::Reset()
+{
+	if (m_spWatchThread)
+	{
+		SetEvent(m_hStop);
+		m_spWatchThread->join();
+		m_spWatchThread.reset();
+	}
+
+	if (m_hStop != NULL)
+	{
+		CloseHandle(m_hStop);
+		m_hStop = NULL;
+	}
+
+	if (m_hChange != INVALID_HANDLE_VALUE)
+	{
+		FindCloseChangeNotification(m_hChange);
+		m_hChange = INVALID_HANDLE_VALUE;
+	}
+
+	std::lock_guard<std::mutex> lock{ m_ScanLock };
+
+	m_strRoot.clear();
+
+	std::atomic_store(&m_spFiles, std::shared_ptr<const FileSet>());
+}
+
+void XEFMOverlay::Refresh()
+{
+	//    ,        .
+	std::lock_guard<std::mutex> lock{ m_ScanLock };
+
+	if (!m_strRoot.empty())
+	{
+		std::atomic_store(&m_spFiles, Scan(m_strRoot));
+	}
+}
+
+bool XEFMOverlay::Find(std::wstring_view strPath) const
+{
+	std::shared_ptr<const FileSet> spFiles = std::atomic_load(&m_spFiles);
+
+	return (spFiles) && (spFiles->find(Normalize(strPath)) != spFiles->end());
+}
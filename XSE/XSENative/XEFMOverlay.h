@@ -0,0 +1,60 @@
+#pragma once
+
+#include "XGlobals.h"
+
+/*
+
+       (     ). 
+   ,    --    -,  
+  .      (FindFirstChangeNotification)  
+ :          ,      
+  .   ,    Refresh().
+
+     , '/'  '\'  .
+
+*/
+
+class XEFMOverlay
+{
+private:
+	using FileSet = std::unordered_set<std::wstring>;   //  ,  Normalize()
+
+	std::wstring                   m_strRoot;
+
+	//   (std::atomic_load / std::atomic_store), nullptr --   .
+	std::shared_ptr<const FileSet> m_spFiles;
+
+	//      (Refresh()   ).
+	std::mutex                     m_ScanLock;
+
+	//  .
+	HANDLE                         m_hChange;
+	HANDLE                         m_hStop;
+	std::unique_ptr<std::thread>   m_spWatchThread;
+
+	static std::wstring Normalize(std::wstring_view strPath);
+
+	static std::shared_ptr<const FileSet> Scan(const std::wstring& strRoot);
+
+	void ThreadWatch();
+
+public:
+	XEFMOverlay();
+
+	~XEFMOverlay();
+
+	XEFMOverlay(const XEFMOverlay&) = delete;
+
+	XEFMOverlay& operator = (const XEFMOverlay&) = delete;
+
+	//   strRoot ( )     .
+	void Assign(const std::wstring& strRoot);
+
+	void Reset();
+
+	//     .
+	void Refresh();
+
+	// TRUE,    strPath ( ) .
+	bool Find(std::wstring_view strPath) const;
+};
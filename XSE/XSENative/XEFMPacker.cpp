@@ -0,0 +1,1086 @@
+#include "pch.h"
+#include "XEFMPacker.h"
+#include "XEFMCodec.h"
+#include "XEFMDirectory.h"
+#include "XEFMFormat.h"
+#include "XEFMMapping.h"
+#include "XException.h"
+
+#include <algorithm>
+
+XEFMPacker::XEFMPacker(const XEFMPackSettings& settings) : m_Settings(settings)
+{
+	m_Settings.nBlockSize = max(m_Settings.nBlockSize, 4096u);
+	m_Settings.nBuffers = max(m_Settings.nBuffers, 1u);
+	m_Settings.nCompressBlockSize = min(max(m_Settings.nCompressBlockSize, 4096u), m_Settings.nBlockSize);
+	m_Settings.nAlignment = max(m_Settings.nAlignment, 1u);
+
+	if (!m_Settings.nThreads)
+	{
+		m_Settings.nThreads = max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	m_nWritten = 0;
+	m_nDataSize = 0;
+	m_bAbort = false;
+}
+
+XEFMPacker::~XEFMPacker()
+{
+
+}
+
+void XEFMPacker::CollectFiles(const std::wstring& strRootPath)
+{
+	std::filesystem::recursive_directory_iterator dir_it{ std::filesystem::path{strRootPath} };
+	//     .     .
+	for (const auto& e : dir_it)
+	{
+		if (!e.is_regular_file())
+		{
+			continue;
+		}
+
+		//   ,  .
+		FileEntry f;
+
+		f.strPath = e.path().c_str();
+
+		if (f.strPath.find(strRootPath) != 0)
+		{
+			throw XException(L"XEFMPacker::CollectFiles(): unable to process file '%s'", f.strPath.c_str());
+		}
+
+		//       :
+		XEFMDirectory::ToUTF8(std::wstring_view(f.strPath).substr(strRootPath.length()), f.strName);
+		f.nOffset = 0;
+		f.nSize = std::filesystem::file_size(e.path());
+		f.nStoredSize = 0;
+		f.bCompressed = (m_Settings.bCompress) && (f.nSize);
+		f.nHash = 0;
+		f.nSource = UINT32_MAX;
+		f.bStored = false;
+
+		m_Files.push_back(std::move(f));
+	}
+}
+
+void XEFMPacker::ForEachFile(const std::vector<uint32_t>& vecFiles, const std::function<void(uint32_t, std::vector<char>&)>& process)
+{
+	m_nNextFile = 0;
+	m_bAbort = false;
+
+	std::vector<std::thread> vecThreads;
+	uint32_t nThreads = (uint32_t)min((size_t)m_Settings.nThreads, vecFiles.size());
+
+	for (uint32_t i = 0; i < nThreads; ++i)
+	{
+		vecThreads.emplace_back(&XEFMPacker::FileThread, this, std::cref(vecFiles), std::cref(process));
+	}
+
+	for (auto& t : vecThreads)
+	{
+		t.join();
+	}
+}
+
+void XEFMPacker::FileThread(const std::vector<uint32_t>& vecFiles, const std::function<void(uint32_t, std::vector<char>&)>& process)
+{
+	std::vector<char> buffer;
+
+	try
+	{
+		for (;;)
+		{
+			size_t nFile = m_nNextFile.fetch_add(1);
+
+			if (nFile >= vecFiles.size())
+			{
+				break;
+			}
+
+			{
+				std::unique_lock lock{ m_Lock };
+
+				if (m_bAbort)
+				{
+					break;
+				}
+			}
+
+			process(vecFiles[nFile], buffer);
+		}
+	}
+	catch (const XException& e)
+	{
+		std::unique_lock lock{ m_Lock };
+
+		if (!m_upError)
+		{
+			m_upError = std::make_unique<XException>(e);
+		}
+
+		m_bAbort = true;
+	}
+}
+
+void XEFMPacker::HashFile(FileEntry& f, std::vector<char>& buffer) const
+{
+	std::ifstream srcFile{ f.strPath, std::ios::binary | std::ios::in };
+
+	if (!srcFile.is_open())
+	{
+		throw XException(L"XEFMPacker::HashFile(): can't open source file '%s'", f.strPath.c_str());
+	}
+
+	buffer.resize(m_Settings.nBlockSize);
+
+	// FNV-1a, 64 .
+	uint64_t nHash{ 0xCBF29CE484222325ull };
+	uint64_t nRead{ 0 };
+
+	while (nRead < f.nSize)
+	{
+		srcFile.read(buffer.data(), m_Settings.nBlockSize);
+
+		const size_t nCount = (size_t)srcFile.gcount();
+
+		if (!nCount)
+		{
+			break;
+		}
+
+		for (size_t i = 0; i < nCount; ++i)
+		{
+			nHash = (nHash ^ (uint8_t)buffer[i]) * 0x100000001B3ull;
+		}
+
+		nRead += nCount;
+	}
+
+	if (nRead != f.nSize)
+	{
+		throw XException(L"XEFMPacker::HashFile(): source file '%s' was changed while packing", f.strPath.c_str());
+	}
+
+	f.nHash = nHash;
+}
+
+bool XEFMPacker::CompareFiles(const FileEntry& f1, const FileEntry& f2) const
+{
+	std::ifstream file1{ f1.strPath, std::ios::binary | std::ios::in };
+	std::ifstream file2{ f2.strPath, std::ios::binary | std::ios::in };
+
+	if ((!file1.is_open()) || (!file2.is_open()))
+	{
+		throw XException(L"XEFMPacker::CompareFiles(): can't open source file '%s'", ((!file1.is_open()) ? f1 : f2).strPath.c_str());
+	}
+
+	std::unique_ptr<char[]> spBuffer1{ new char[m_Settings.nBlockSize] };
+	std::unique_ptr<char[]> spBuffer2{ new char[m_Settings.nBlockSize] };
+
+	for (uint64_t nOffset = 0; nOffset < f1.nSize; nOffset += m_Settings.nBlockSize)
+	{
+		const uint32_t nCount = (uint32_t)min((uint64_t)m_Settings.nBlockSize, f1.nSize - nOffset);
+
+		file1.read(spBuffer1.get(), nCount);
+		file2.read(spBuffer2.get(), nCount);
+
+		if (((uint32_t)file1.gcount() != nCount) || ((uint32_t)file2.gcount() != nCount))
+		{
+			throw XException(L"XEFMPacker::CompareFiles(): source file '%s' was changed while packing", f1.strPath.c_str());
+		}
+
+		if (memcmp(spBuffer1.get(), spBuffer2.get(), nCount))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void XEFMPacker::FindDuplicates()
+{
+	//         (  --  ,  ).
+	std::unordered_map<uint64_t, uint32_t> mapSizes;   //  ->  
+
+	for (const auto& f : m_Files)
+	{
+		if (!f.bStored)
+		{
+			++mapSizes[f.nSize];
+		}
+	}
+
+	std::vector<uint32_t> vecFiles;
+
+	for (uint32_t i = 0; i < (uint32_t)m_Files.size(); ++i)
+	{
+		if ((m_Files[i].nSize) && (!m_Files[i].bStored) && (mapSizes[m_Files[i].nSize] > 1))
+		{
+			vecFiles.push_back(i);
+		}
+	}
+
+	if (vecFiles.empty())
+	{
+		return;
+	}
+
+	//  -- .
+	ForEachFile(vecFiles, [this](uint32_t nFile, std::vector<char>& buffer) { HashFile(m_Files[nFile], buffer); });
+
+	if (m_upError)
+	{
+		throw XException(*m_upError, L"XEFMPacker::FindDuplicates(): can't read source files");
+	}
+
+	//            ( 
+	// ,    --   ).
+	std::unordered_map<uint64_t, std::vector<uint32_t>> mapOriginals;
+
+	for (uint32_t nFile : vecFiles)
+	{
+		FileEntry& f = m_Files[nFile];
+		auto& vecOriginals = mapOriginals[f.nHash];
+
+		for (uint32_t nOriginal : vecOriginals)
+		{
+			if ((m_Files[nOriginal].nSize == f.nSize) && (CompareFiles(m_Files[nOriginal], f)))
+			{
+				f.nSource = nOriginal;
+				break;
+			}
+		}
+
+		if (f.nSource == UINT32_MAX)
+		{
+			vecOriginals.push_back(nFile);
+		}
+	}
+}
+
+void XEFMPacker::MakeBlocks()
+{
+	for (uint32_t i = 0; i < (uint32_t)m_Files.size(); ++i)
+	{
+		const FileEntry& f = m_Files[i];
+
+		if ((f.nSource != UINT32_MAX) || (f.bStored))
+		{
+			continue;
+		}
+
+		//   (  --  ):
+		const uint32_t nBlockSize = (f.bCompressed) ? m_Settings.nCompressBlockSize : m_Settings.nBlockSize;
+
+		for (uint64_t nOffset = 0; nOffset < f.nSize; nOffset += nBlockSize)
+		{
+			m_Blocks.push_back({ i, nOffset, (uint32_t)min((uint64_t)nBlockSize, f.nSize - nOffset) });
+		}
+	}
+}
+
+void XEFMPacker::ReaderThread()
+{
+	std::ifstream srcFile;
+	uint32_t      nOpenFile{ UINT32_MAX };
+
+	try
+	{
+		for (;;)
+		{
+			size_t nBlock = m_nNextBlock.fetch_add(1);
+
+			if (nBlock >= m_Blocks.size())
+			{
+				break;
+			}
+
+			Slot& slot = m_Slots[nBlock % m_Slots.size()];
+
+			{
+				// ,    .
+				std::unique_lock lock{ m_Lock };
+
+				m_cvWritten.wait(lock, [this, nBlock]() { return (m_bAbort) || (nBlock < m_nWritten + m_Slots.size()); });
+
+				if (m_bAbort)
+				{
+					break;
+				}
+			}
+
+			const Block& b = m_Blocks[nBlock];
+			const FileEntry& f = m_Files[b.nFile];
+
+			if (nOpenFile != b.nFile)
+			{
+				srcFile.close();
+				srcFile.clear();
+				srcFile.open(f.strPath, std::ios::binary | std::ios::in);
+
+				if (!srcFile.is_open())
+				{
+					throw XException(L"XEFMPacker::ReaderThread(): can't open source file '%s'", f.strPath.c_str());
+				}
+
+				nOpenFile = b.nFile;
+			}
+
+			srcFile.seekg(b.nOffset);
+			srcFile.read(slot.spData.get(), b.nSize);
+
+			if ((uint32_t)srcFile.gcount() != b.nSize)
+			{
+				//    ,     .
+				throw XException(L"XEFMPacker::ReaderThread(): source file '%s' was changed while packing", f.strPath.c_str());
+			}
+
+			// ,   ,   .
+			slot.bPacked = false;
+
+			if (f.bCompressed)
+			{
+				XEFMCodec::Compress(reinterpret_cast<const std::byte*>(slot.spData.get()), b.nSize, slot.Packed);
+
+				slot.bPacked = slot.Packed.size() < b.nSize;
+			}
+
+			{
+				std::unique_lock lock{ m_Lock };
+
+				slot.nBlock = nBlock;
+				slot.bReady = true;
+			}
+
+			m_cvReady.notify_one();
+		}
+	}
+	catch (const XException& e)
+	{
+		std::unique_lock lock{ m_Lock };
+
+		if (!m_upError)
+		{
+			m_upError = std::make_unique<XException>(e);
+		}
+
+		m_bAbort = true;
+
+		m_cvReady.notify_all();
+		m_cvWritten.notify_all();
+	}
+}
+
+void XEFMPacker::CopyData(std::ostream& stgFile, uint64_t nStart)
+{
+	uint64_t nPos = nStart;
+	uint32_t nNextFile{ 0 };
+
+	std::vector<uint64_t> vecBlocks;   //     
+	std::vector<char>     vecPadding((m_Settings.nAlignThreshold) ? m_Settings.nAlignment : 0, '\0');
+
+	XEFMPackProgress progress{ (uint32_t)m_Files.size(), 0, 0, 0, 0.0, 0.0 };
+
+	for (const auto& f : m_Files)
+	{
+		if ((f.nSource == UINT32_MAX) && (!f.bStored))
+		{
+			progress.nBytes += f.nSize;
+		}
+	}
+
+	m_Slots.resize(min((size_t)m_Settings.nBuffers, max(m_Blocks.size(), (size_t)1)));
+
+	for (auto& slot : m_Slots)
+	{
+		slot.spData.reset(new char[m_Settings.nBlockSize]);
+		slot.bPacked = false;
+		slot.bReady = false;
+	}
+
+	m_nNextBlock = 0;
+	m_nWritten = 0;
+	m_bAbort = false;
+
+	const auto t0 = std::chrono::steady_clock::now();
+	auto tReport = t0;
+
+	auto report = [this, &progress, t0, &tReport](bool bLast)
+	{
+		auto t = std::chrono::steady_clock::now();
+
+		if ((!m_Settings.Progress) ||
+			((!bLast) && (t - tReport < std::chrono::milliseconds(m_Settings.nProgressInterval))))
+		{
+			return;
+		}
+
+		tReport = t;
+		progress.fSeconds = std::chrono::duration<double>(t - t0).count();
+		progress.fMBps = (progress.fSeconds > 0) ? (progress.nBytesDone / progress.fSeconds / (1024.0 * 1024.0)) : 0.0;
+
+		m_Settings.Progress(progress);
+	};
+
+	std::vector<std::thread> vecThreads;
+	uint32_t nThreads = (uint32_t)min((size_t)m_Settings.nThreads, m_Blocks.size());
+
+	for (uint32_t i = 0; i < nThreads; ++i)
+	{
+		vecThreads.emplace_back(&XEFMPacker::ReaderThread, this);
+	}
+
+	auto write = [&stgFile, &nPos](const void* pData, size_t nSize)
+	{
+		stgFile.write(reinterpret_cast<const char*>(pData), nSize);
+
+		if (!stgFile.good())
+		{
+			throw XException(L"XEFMPacker::CopyData(): can't write storage file");
+		}
+
+		nPos += nSize;
+	};
+
+	//    nFile   .
+	auto skip_files = [this, &nPos, &nNextFile](uint32_t nFile)
+	{
+		for (; nNextFile < nFile; ++nNextFile)
+		{
+			if (m_Files[nNextFile].bStored)
+			{
+				continue;
+			}
+
+			m_Files[nNextFile].nOffset = nPos;
+			m_Files[nNextFile].nStoredSize = 0;
+		}
+	};
+
+	//    .
+	auto write_blocks = [&]()
+	{
+		for (size_t nBlock = 0; nBlock < m_Blocks.size(); ++nBlock)
+		{
+			Slot& slot = m_Slots[nBlock % m_Slots.size()];
+
+			{
+				std::unique_lock lock{ m_Lock };
+
+				m_cvReady.wait(lock, [this, &slot, nBlock]() { return (m_bAbort) || ((slot.bReady) && (slot.nBlock == nBlock)); });
+
+				if (m_bAbort)
+				{
+					return;
+				}
+			}
+
+			const Block& b = m_Blocks[nBlock];
+			FileEntry& f = m_Files[b.nFile];
+
+			if (!b.nOffset)
+			{
+				//   .
+				skip_files(b.nFile);
+
+				if ((m_Settings.nAlignThreshold) && (f.nSize >= m_Settings.nAlignThreshold) && (nPos % m_Settings.nAlignment))
+				{
+					write(vecPadding.data(), (size_t)(m_Settings.nAlignment - nPos % m_Settings.nAlignment));
+				}
+
+				f.nOffset = nPos;
+				nNextFile = b.nFile + 1;
+
+				if (f.bCompressed)
+				{
+					//   ,     .
+					XEFMLZWIndexType index{ f.nSize, m_Settings.nCompressBlockSize,
+						(uint32_t)((f.nSize + m_Settings.nCompressBlockSize - 1) / m_Settings.nCompressBlockSize) };
+
+					vecBlocks.assign(index.NumBlocks + 1, 0);
+
+					write(&index, sizeof(XEFMLZWIndexType));
+					write(vecBlocks.data(), vecBlocks.size() * sizeof(uint64_t));
+
+					vecBlocks.clear();
+				}
+			}
+
+			if (f.bCompressed)
+			{
+				vecBlocks.push_back(nPos - f.nOffset);
+			}
+
+			if (slot.bPacked)
+			{
+				write(slot.Packed.data(), slot.Packed.size());
+			}
+			else
+			{
+				write(slot.spData.get(), b.nSize);
+			}
+
+			if (b.nOffset + b.nSize == f.nSize)
+			{
+				//   .
+				f.nStoredSize = nPos - f.nOffset;
+
+				if (f.bCompressed)
+				{
+					vecBlocks.push_back(f.nStoredSize);
+
+					stgFile.seekp(f.nOffset + sizeof(XEFMLZWIndexType));
+					stgFile.write(reinterpret_cast<const char*>(vecBlocks.data()), vecBlocks.size() * sizeof(uint64_t));
+					stgFile.seekp(nPos);
+
+					if (!stgFile.good())
+					{
+						throw XException(L"XEFMPacker::CopyData(): can't write storage file");
+					}
+				}
+			}
+
+			{
+				std::unique_lock lock{ m_Lock };
+
+				slot.bReady = false;
+				m_nWritten = nBlock + 1;
+			}
+
+			m_cvWritten.notify_all();
+
+			progress.nBytesDone += b.nSize;
+			progress.nFilesDone = b.nFile + ((b.nOffset + b.nSize == m_Files[b.nFile].nSize) ? 1 : 0);
+
+			report(false);
+		}
+	};
+
+	try
+	{
+		write_blocks();
+	}
+	catch (const XException&)
+	{
+		{
+			std::unique_lock lock{ m_Lock };
+
+			m_bAbort = true;
+		}
+
+		m_cvWritten.notify_all();
+
+		for (auto& t : vecThreads)
+		{
+			t.join();
+		}
+
+		throw;
+	}
+
+	for (auto& t : vecThreads)
+	{
+		t.join();
+	}
+
+	if (m_upError)
+	{
+		throw XException(*m_upError, L"XEFMPacker::CopyData(): can't read source files");
+	}
+
+	skip_files((uint32_t)m_Files.size());
+
+	//     .
+	for (auto& f : m_Files)
+	{
+		if (f.nSource != UINT32_MAX)
+		{
+			f.nOffset = m_Files[f.nSource].nOffset;
+			f.nStoredSize = m_Files[f.nSource].nStoredSize;
+		}
+	}
+
+	m_nDataSize = nPos - nStart;
+
+	progress.nFilesDone = progress.nFiles;
+
+	report(true);
+}
+
+std::vector<XEFMDirectoryEntry> XEFMPacker::MakeEntries() const
+{
+	std::vector<XEFMDirectoryEntry> vecEntries;
+
+	vecEntries.reserve(m_Files.size() + m_Deleted.size());
+
+	for (const auto& f : m_Files)
+	{
+		vecEntries.push_back({ f.strName, f.nOffset, f.nStoredSize, (f.bCompressed) ? XEFM_ENTRY_LZW : 0 });
+	}
+
+	for (const auto& strName : m_Deleted)
+	{
+		vecEntries.push_back({ strName, 0, 0, XEFM_ENTRY_DELETED });
+	}
+
+	return vecEntries;
+}
+
+uint32_t XEFMPacker::GetDirectorySize() const
+{
+	size_t nNamesSize{ 0 };
+
+	for (const auto& f : m_Files)
+	{
+		nNamesSize += f.strName.size();
+	}
+
+	for (const auto& strName : m_Deleted)
+	{
+		nNamesSize += strName.size();
+	}
+
+	return XEFMDirectory::GetBlockSize((uint32_t)(m_Files.size() + m_Deleted.size()), nNamesSize);
+}
+
+void XEFMPacker::WriteDirectory(std::ostream& stgFile)
+{
+	std::vector<XEFMDirectoryEntry> vecEntries = MakeEntries();
+
+	XEFMHeader3Type header{ (uint32_t)vecEntries.size(), XEFMDirectory::GetBucketCount((uint32_t)vecEntries.size()), GetDirectorySize(), m_nDataSize };
+
+	//    --  .
+	std::string strDirectory = XEFMDirectory::Build(vecEntries);
+
+	strDirectory.insert(0, reinterpret_cast<const char*>(&header), sizeof(XEFMHeader3Type));
+
+	stgFile.seekp(0);
+	stgFile.write(strDirectory.data(), strDirectory.size());
+
+	if (!stgFile.good())
+	{
+		throw XException(L"XEFMPacker::WriteDirectory(): can't write storage file");
+	}
+}
+
+void XEFMPacker::Pack(const wchar_t* pDir, const wchar_t* pStorage)
+{
+	if (!std::filesystem::path(pDir).is_absolute())
+	{
+		//    .
+		throw XException(L"XEFMPacker::Pack(): invalid path '%s' (must be absolute)", pDir);
+	}
+
+	m_Files.clear();
+	m_Blocks.clear();
+	m_Deleted.clear();
+
+	try
+	{
+		std::filesystem::current_path(pDir);
+
+		const std::wstring strRootPath = std::filesystem::current_path();
+
+		CollectFiles(strRootPath);
+
+		if (m_Settings.bDeduplicate)
+		{
+			FindDuplicates();
+		}
+
+		MakeBlocks();
+
+		//     .
+		std::ofstream stgFile{ pStorage, std::ios::out | std::ios::binary | std::ios::trunc };
+
+		if (!stgFile.is_open())
+		{
+			throw XException(L"XEFMPacker::Pack(): can't create storage file '%s'", pStorage);
+		}
+
+		//     ,    .
+		std::string strPlaceholder(sizeof(XEFMHeader3Type) + GetDirectorySize(), '\0');
+
+		stgFile.write(strPlaceholder.data(), strPlaceholder.size());
+
+		//      .
+		CopyData(stgFile, strPlaceholder.size());
+		WriteDirectory(stgFile);
+	}
+	catch (const std::exception& e)
+	{
+		UNREFERENCED_PARAMETER(e);
+
+		throw XException(L"XEFMPacker::Pack(): internal error");
+	}
+}
+
+void XEFMPacker::FindStored(const XEFMMapping& storage, const std::vector<XEFMDirectoryEntry>& entries)
+{
+	std::unordered_map<std::string_view, const XEFMDirectoryEntry*> mapEntries;
+
+	for (const auto& entry : entries)
+	{
+		mapEntries[entry.strName] = &entry;
+	}
+
+	// ,     ,    .
+	std::vector<uint32_t> vecFiles;
+	std::vector<const XEFMDirectoryEntry*> vecEntries(m_Files.size(), nullptr);
+
+	for (uint32_t i = 0; i < (uint32_t)m_Files.size(); ++i)
+	{
+		auto it = mapEntries.find(m_Files[i].strName);
+
+		if (it == mapEntries.end())
+		{
+			continue;
+		}
+
+		if (!(it->second->nFlags & XEFM_ENTRY_DELETED))
+		{
+			vecEntries[i] = it->second;
+			vecFiles.push_back(i);
+		}
+
+		mapEntries.erase(it);
+	}
+
+	//    (  )  .
+	for (const auto& entry : entries)
+	{
+		if (mapEntries.count(entry.strName))
+		{
+			m_Deleted.push_back(entry.strName);
+		}
+	}
+
+	ForEachFile(vecFiles, [this, &storage, &vecEntries](uint32_t nFile, std::vector<char>& buffer)
+	{
+		FileEntry& f = m_Files[nFile];
+		const XEFMDirectoryEntry& entry = *vecEntries[nFile];
+
+		if (CompareStored(f, storage, entry, buffer))
+		{
+			f.bStored = true;
+			f.nOffset = entry.nOffset;
+			f.nStoredSize = entry.nSize;
+			f.bCompressed = (entry.nFlags & XEFM_ENTRY_LZW) != 0;
+		}
+	});
+
+	if (m_upError)
+	{
+		throw XException(*m_upError, L"XEFMPacker::FindStored(): can't read source files");
+	}
+}
+
+bool XEFMPacker::CompareStored(const FileEntry& f, const XEFMMapping& storage, const XEFMDirectoryEntry& entry, std::vector<char>& buffer) const
+{
+	//       .
+	const std::byte* pData = storage.GetData() + entry.nOffset;
+	const bool bCompressed = (entry.nFlags & XEFM_ENTRY_LZW) != 0;
+
+	//     ,  --  .
+	XEFMLZWIndexType index{ entry.nSize, m_Settings.nBlockSize, 0 };
+
+	if (bCompressed)
+	{
+		if (entry.nSize < sizeof(XEFMLZWIndexType))
+		{
+			return false;
+		}
+
+		memcpy(&index, pData, sizeof(XEFMLZWIndexType));
+
+		//   (    nBlockSize)     .
+		if ((!index.BlockSize) || (index.BlockSize > m_Settings.nBlockSize) ||
+			((index.Size + index.BlockSize - 1) / index.BlockSize != index.NumBlocks) ||
+			(sizeof(XEFMLZWIndexType) + (index.NumBlocks + 1ull) * sizeof(uint64_t) > entry.nSize))
+		{
+			return false;
+		}
+	}
+
+	if (index.Size != f.nSize)
+	{
+		return false;
+	}
+
+	std::ifstream srcFile{ f.strPath, std::ios::binary | std::ios::in };
+
+	if (!srcFile.is_open())
+	{
+		throw XException(L"XEFMPacker::CompareStored(): can't open source file '%s'", f.strPath.c_str());
+	}
+
+	std::vector<std::byte> vecUnpacked;
+
+	buffer.resize(index.BlockSize);
+
+	for (uint64_t nBlock = 0; nBlock * index.BlockSize < index.Size; ++nBlock)
+	{
+		const size_t nCount = (size_t)min((uint64_t)index.BlockSize, index.Size - nBlock * index.BlockSize);
+		const std::byte* pBlock = pData + nBlock * index.BlockSize;
+
+		srcFile.read(buffer.data(), nCount);
+
+		if ((size_t)srcFile.gcount() != nCount)
+		{
+			throw XException(L"XEFMPacker::CompareStored(): source file '%s' was changed while packing", f.strPath.c_str());
+		}
+
+		if (bCompressed)
+		{
+			uint64_t nBegin, nEnd;
+
+			memcpy(&nBegin, pData + sizeof(XEFMLZWIndexType) + nBlock * sizeof(uint64_t), sizeof(uint64_t));
+			memcpy(&nEnd, pData + sizeof(XEFMLZWIndexType) + (nBlock + 1) * sizeof(uint64_t), sizeof(uint64_t));
+
+			if ((nBegin > nEnd) || (nEnd > entry.nSize) || (nEnd - nBegin > nCount))
+			{
+				return false;
+			}
+
+			pBlock = pData + nBegin;
+
+			if (nEnd - nBegin < nCount)
+			{
+				vecUnpacked.resize(nCount);
+
+				try
+				{
+					XEFMCodec::Decompress(pBlock, (size_t)(nEnd - nBegin), vecUnpacked.data(), nCount);
+				}
+				catch (const XException&)
+				{
+					return false;
+				}
+
+				pBlock = vecUnpacked.data();
+			}
+		}
+
+		if (memcmp(buffer.data(), pBlock, nCount))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void XEFMPacker::Update(const wchar_t* pDir, const wchar_t* pStorage, std::shared_ptr<const XEFMMapping> spStorage,
+	const std::vector<XEFMDirectoryEntry>& entries)
+{
+	if (!std::filesystem::path(pDir).is_absolute())
+	{
+		//    .
+		throw XException(L"XEFMPacker::Update(): invalid path '%s' (must be absolute)", pDir);
+	}
+
+	//   3.x:  3.2        .
+	XEFMHeader32Type header{ 0, 0, 0, 0, 0 };
+
+	memcpy(&header, spStorage->GetData(), (size_t)min((uint64_t)sizeof(XEFMHeader32Type), spStorage->GetSize()));
+
+	if ((spStorage->GetSize() < sizeof(XEFMHeader3Type)) || (strncmp(header.Label, "EFILE", 5) != 0) || (header.VerHi != 3))
+	{
+		throw XException(L"XEFMPacker::Update(): storage file '%s' can't be updated (version 3.x is required)", pStorage);
+	}
+
+	const uint32_t nGeneration = (header.VerLo == 2) ? header.Generation + 1 : 1;
+
+	//   --    (    3.2,    3.0  3.1).
+	const uint64_t nStart = max(spStorage->GetSize(), (uint64_t)sizeof(XEFMHeader32Type));
+
+	m_Files.clear();
+	m_Blocks.clear();
+	m_Deleted.clear();
+
+	try
+	{
+		std::filesystem::current_path(pDir);
+
+		const std::wstring strRootPath = std::filesystem::current_path();
+
+		CollectFiles(strRootPath);
+		FindStored(*spStorage, entries);
+
+		//     .
+		spStorage.reset();
+
+		const size_t nLive = (size_t)std::count_if(entries.begin(), entries.end(), [](const auto& entry) { return !(entry.nFlags & XEFM_ENTRY_DELETED); });
+
+		if ((m_Files.size() == nLive) && (std::all_of(m_Files.begin(), m_Files.end(), [](const auto& f) { return f.bStored; })))
+		{
+			//   .
+			return;
+		}
+
+		if (m_Settings.bDeduplicate)
+		{
+			FindDuplicates();
+		}
+
+		MakeBlocks();
+
+		std::fstream stgFile{ pStorage, std::ios::in | std::ios::out | std::ios::binary };
+
+		if (!stgFile.is_open())
+		{
+			throw XException(L"XEFMPacker::Update(): can't open storage file '%s'", pStorage);
+		}
+
+		stgFile.seekp(nStart);
+
+		CopyData(stgFile, nStart);
+
+		//   --  ,    8.
+		const uint64_t nDirectoryOffset = (nStart + m_nDataSize + 7) & ~7ull;
+		const std::vector<XEFMDirectoryEntry> vecEntries = MakeEntries();
+
+		std::string strDirectory((size_t)(nDirectoryOffset - nStart - m_nDataSize), '\0');
+
+		strDirectory += XEFMDirectory::Build(vecEntries);
+
+		stgFile.write(strDirectory.data(), strDirectory.size());
+		stgFile.close();
+
+		if (!stgFile)
+		{
+			throw XException(L"XEFMPacker::Update(): can't write storage file '%s'", pStorage);
+		}
+
+		//     --   .      
+		//  ,    --  :       .
+		XEFMHeader32Type newHeader{ (uint32_t)vecEntries.size(), XEFMDirectory::GetBucketCount((uint32_t)vecEntries.size()),
+			GetDirectorySize(), nDirectoryOffset, nGeneration };
+
+		HANDLE hFile = CreateFileW(pStorage, GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (hFile == INVALID_HANDLE_VALUE)
+		{
+			throw XException(L"XEFMPacker::Update(): can't open storage file '%s'", pStorage);
+		}
+
+		OVERLAPPED overlapped{};   //    
+		DWORD nWritten = 0;
+
+		const bool bWritten = (FlushFileBuffers(hFile)) &&
+			(WriteFile(hFile, &newHeader, sizeof(XEFMHeader32Type), &nWritten, &overlapped)) &&
+			(nWritten == sizeof(XEFMHeader32Type)) && (FlushFileBuffers(hFile));
+
+		CloseHandle(hFile);
+
+		if (!bWritten)
+		{
+			throw XException(L"XEFMPacker::Update(): can't write storage file '%s'", pStorage);
+		}
+	}
+	catch (const std::exception& e)
+	{
+		UNREFERENCED_PARAMETER(e);
+
+		throw XException(L"XEFMPacker::Update(): internal error");
+	}
+}
+
+void XEFMPacker::Compact(const XEFMMapping& storage, const std::vector<XEFMDirectoryEntry>& entries, const wchar_t* pStorage)
+{
+	m_Files.clear();
+	m_Blocks.clear();
+	m_Deleted.clear();
+
+	for (const auto& entry : entries)
+	{
+		if (!(entry.nFlags & XEFM_ENTRY_DELETED))
+		{
+			//    ; nSize --   (   ),
+			//    --    (CopyData()).
+			uint64_t nSize = entry.nSize;
+
+			if ((entry.nFlags & XEFM_ENTRY_LZW) && (entry.nSize >= sizeof(XEFMLZWIndexType)))
+			{
+				XEFMLZWIndexType index;
+
+				memcpy(&index, storage.GetData() + entry.nOffset, sizeof(XEFMLZWIndexType));
+				nSize = index.Size;
+			}
+
+			m_Files.push_back({ L"", entry.strName, entry.nOffset, nSize, entry.nSize, (entry.nFlags & XEFM_ENTRY_LZW) != 0, 0, UINT32_MAX, true });
+		}
+	}
+
+	//   --    .
+	std::stable_sort(m_Files.begin(), m_Files.end(), [](const FileEntry& f1, const FileEntry& f2) { return f1.nOffset < f2.nOffset; });
+
+	try
+	{
+		std::ofstream stgFile{ pStorage, std::ios::out | std::ios::binary | std::ios::trunc };
+
+		if (!stgFile.is_open())
+		{
+			throw XException(L"XEFMPacker::Compact(): can't create storage file '%s'", pStorage);
+		}
+
+		//     ,    .
+		const uint64_t nStart = sizeof(XEFMHeader3Type) + GetDirectorySize();
+		uint64_t nPos = nStart;
+
+		std::string strPlaceholder((size_t)nStart, '\0');
+		std::vector<char> vecPadding((m_Settings.nAlignThreshold) ? m_Settings.nAlignment : 0, '\0');
+		std::unordered_map<uint64_t, uint64_t> mapOffsets;   //     ->   (   )
+
+		stgFile.write(strPlaceholder.data(), strPlaceholder.size());
+
+		for (auto& f : m_Files)
+		{
+			if (!f.nStoredSize)
+			{
+				f.nOffset = nPos;
+				continue;
+			}
+
+			auto it = mapOffsets.find(f.nOffset);
+
+			if (it != mapOffsets.end())
+			{
+				f.nOffset = it->second;
+				continue;
+			}
+
+			if ((m_Settings.nAlignThreshold) && (f.nSize >= m_Settings.nAlignThreshold) && (nPos % m_Settings.nAlignment))
+			{
+				const size_t nPadding = (size_t)(m_Settings.nAlignment - nPos % m_Settings.nAlignment);
+
+				stgFile.write(vecPadding.data(), nPadding);
+				nPos += nPadding;
+			}
+
+			stgFile.write(reinterpret_cast<const char*>(storage.GetData() + f.nOffset), (std::streamsize)f.nStoredSize);
+
+			if (!stgFile.good())
+			{
+				throw XException(L"XEFMPacker::Compact(): can't write storage file '%s'", pStorage);
+			}
+
+			mapOffsets[f.nOffset] = nPos;
+			f.nOffset = nPos;
+			nPos += f.nStoredSize;
+		}
+
+		m_nDataSize = nPos - nStart;
+
+		WriteDirectory(stgFile);
+	}
+	catch (const std::exception& e)
+	{
+		UNREFERENCED_PARAMETER(e);
+
+		throw XException(L"XEFMPacker::Compact(): internal error");
+	}
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "XGlobals.h"
+
+class XException;
+class XEFMMapping;
+struct XEFMDirectoryEntry;
+
+//  ,   XEFMPackSettings::Progress.
+struct XEFMPackProgress
+{
+	uint32_t nFiles;       //  
+	uint32_t nFilesDone;   //   
+	uint64_t nBytes;       //   
+	uint64_t nBytesDone;   //   
+	double   fSeconds;     //   
+	double   fMBps;        //   , /
+};
+
+//  .
+struct XEFMPackSettings
+{
+	uint32_t nThreads{ 0 };             //  , 0 --   
+	uint32_t nBlockSize{ 4 << 20 };     //   
+	uint32_t nBuffers{ 16 };            //     (    )
+	uint32_t nProgressInterval{ 250 };  //    Progress (  -- )
+	bool     bCompress{ false };        //   (XEFM_ENTRY_LZW)
+	bool     bDeduplicate{ true };      //       
+	uint32_t nCompressBlockSize{ 64 << 10 };  //     (  nBlockSize)
+	uint64_t nAlignThreshold{ 0 };      //        nAlignment, 0 --  
+	uint32_t nAlignment{ 4096 };        //     (,    )
+
+	std::function<void(const XEFMPackProgress&)> Progress;
+};
+
+/*
+
+  .     nBlockSize :     
+       ,         , 
+      .    N ,      
+ N - nBuffers,       nBuffers ,     
+  .
+
+     3.1 (XEFMFormat.h): , ,   . 
+      ,      ,   
+   ,      .
+
+        nCompressBlockSize ,      .
+         .
+
+     :      nThreads 
+ ( ,      ),     
+ .    ,         .
+
+   ( nAlignThreshold )    nAlignment:    
+   ,    .         
+     (FILE_FLAG_NO_BUFFERING)   .
+
+
+  (Update())          :
+          (,    ) , 
+  ,   . ,     ,    .
+     , ,     , --  3.2,  
+   (XEFMFormat.h).
+  (Compact())       3.1  ,  .
+
+*/
+
+class XEFMPacker
+{
+private:
+	struct FileEntry
+	{
+		std::wstring strPath;   //    FAT
+		std::string  strName;   //     (UTF-8)
+		uint64_t     nOffset;
+		uint64_t     nSize;
+		uint64_t     nStoredSize;   //  
+		bool         bCompressed;
+		uint64_t     nHash;         //   (  ,       )
+		uint32_t     nSource;       //     ,   ,  UINT32_MAX
+		bool         bStored;       //    ,  --   (nOffset, nStoredSize)
+	};
+
+	struct Block
+	{
+		uint32_t nFile;
+		uint64_t nOffset;       //   
+		uint32_t nSize;
+	};
+
+	struct Slot
+	{
+		std::unique_ptr<char[]> spData;
+		std::vector<std::byte>  Packed;    //  
+		bool                    bPacked;   //  Packed ( )
+		size_t                  nBlock;    //   
+		bool                    bReady;    //  
+	};
+
+	XEFMPackSettings             m_Settings;
+	std::vector<FileEntry>       m_Files;
+	std::vector<Block>           m_Blocks;
+	std::vector<std::string>     m_Deleted;      //    (  UTF-8)
+	uint64_t                     m_nDataSize;    //   
+
+	//       .
+	std::atomic<size_t>          m_nNextFile;    //    
+
+	//  .
+	std::vector<Slot>            m_Slots;
+	std::atomic<size_t>          m_nNextBlock;   //    
+	size_t                       m_nWritten;     //  
+	bool                         m_bAbort;
+	std::unique_ptr<XException>  m_upError;      //      
+	std::mutex                   m_Lock;
+	std::condition_variable      m_cvReady;      //  
+	std::condition_variable      m_cvWritten;    //  
+
+	void CollectFiles(const std::wstring& strRootPath);
+
+	//   vecFiles  nThreads  (process      ),
+	//   --  m_upError.
+	void ForEachFile(const std::vector<uint32_t>& vecFiles, const std::function<void(uint32_t, std::vector<char>&)>& process);
+
+	void FileThread(const std::vector<uint32_t>& vecFiles, const std::function<void(uint32_t, std::vector<char>&)>& process);
+
+	//   (FileEntry::nSource).
+	void FindDuplicates();
+
+	void HashFile(FileEntry& f, std::vector<char>& buffer) const;
+
+	bool CompareFiles(const FileEntry& f1, const FileEntry& f2) const;
+
+	//  ,    (FileEntry::bStored),   (m_Deleted).
+	void FindStored(const XEFMMapping& storage, const std::vector<XEFMDirectoryEntry>& entries);
+
+	bool CompareStored(const FileEntry& f, const XEFMMapping& storage, const XEFMDirectoryEntry& entry, std::vector<char>& buffer) const;
+
+	//   ( )   .
+	void MakeBlocks();
+
+	void ReaderThread();
+
+	//     nStart (  --  m_nDataSize).
+	void CopyData(std::ostream& stgFile, uint64_t nStart);
+
+	//  :   .
+	std::vector<XEFMDirectoryEntry> MakeEntries() const;
+
+	uint32_t GetDirectorySize() const;
+
+	//     (  ,    ).
+	void WriteDirectory(std::ostream& stgFile);
+
+public:
+	XEFMPacker(const XEFMPackSettings& settings = XEFMPackSettings());
+
+	~XEFMPacker();
+
+	//   pStorage       pDir.
+	void Pack(const wchar_t* pDir, const wchar_t* pStorage);
+
+	//   pStorage (3.x)   pDir. spStorage --  , entries --
+	//  ;      .
+	void Update(const wchar_t* pDir, const wchar_t* pStorage, std::shared_ptr<const XEFMMapping> spStorage,
+		const std::vector<XEFMDirectoryEntry>& entries);
+
+	//   pStorage     entries  storage ( ).
+	void Compact(const XEFMMapping& storage, const std::vector<XEFMDirectoryEntry>& entries, const wchar_t* pStorage);
+};
@@ -0,0 +1,120 @@
+#include "pch.h"
+#include "XEFMPrefetcher.h"
+
+#include <algorithm>
+
+XEFMPrefetcher::XEFMPrefetcher()
+{
+	m_bStop = false;
+}
+
+XEFMPrefetcher::~XEFMPrefetcher()
+{
+	{
+		std::unique_lock lock{ m_Lock };
+
+		m_bStop = true;
+	}
+
+	m_cvJobs.notify_all();
+
+	if (m_spThread)
+	{
+		m_spThread->join();
+		m_spThread.reset();
+	}
+}
+
+void XEFMPrefetcher::Prefetch(const XEFMPrefetchRange& range)
+{
+	const uint64_t nEnd = min(range.nOffset + range.nSize, range.spMapping->GetSize());
+
+	if (range.nOffset >= nEnd)
+	{
+		return;
+	}
+
+	const std::byte* pData = range.spMapping->GetData();
+
+	//   :    ,    .
+	WIN32_MEMORY_RANGE_ENTRY entry{ const_cast<std::byte*>(pData + range.nOffset), (SIZE_T)(nEnd - range.nOffset) };
+
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &entry, 0);
+
+	const uint64_t nPageSize{ 4096 };
+	volatile std::byte nTouch;
+
+	for (uint64_t nPos = range.nOffset; nPos < nEnd; nPos = (nPos / nPageSize + 1) * nPageSize)
+	{
+		nTouch = pData[nPos];
+	}
+}
+
+void XEFMPrefetcher::ThreadPrefetch()
+{
+	for (;;)
+	{
+		Job job;
+
+		{
+			std::unique_lock lock{ m_Lock };
+
+			m_cvJobs.wait(lock, [this]() { return (m_bStop) || (!m_Jobs.empty()); });
+
+			if (m_Jobs.empty())
+			{
+				// .
+				break;
+			}
+
+			job = std::move(m_Jobs.front());
+			m_Jobs.pop();
+		}
+
+		//     (   ).
+		std::sort(job.Ranges.begin(), job.Ranges.end(), [](const XEFMPrefetchRange& r1, const XEFMPrefetchRange& r2)
+		{
+			return (r1.spMapping != r2.spMapping) ? (r1.spMapping < r2.spMapping) : (r1.nOffset < r2.nOffset);
+		});
+
+		for (const auto& range : job.Ranges)
+		{
+			{
+				std::unique_lock lock{ m_Lock };
+
+				if (m_bStop)
+				{
+					break;
+				}
+			}
+
+			Prefetch(range);
+		}
+
+		job.Done.set_value();
+	}
+}
+
+std::future<void> XEFMPrefetcher::Add(std::vector<XEFMPrefetchRange> ranges)
+{
+	Job job;
+
+	job.Ranges = std::move(ranges);
+
+	std::future<void> result = job.Done.get_future();
+
+	{
+		std::unique_lock lock{ m_Lock };
+
+		if (!m_spThread)
+		{
+			m_spThread.reset(new std::thread(&XEFMPrefetcher::ThreadPrefetch, this));
+		}
+
+		m_Jobs.push(std::move(job));
+	}
+
+	m_cvJobs.notify_one();
+
+	return result;
+}
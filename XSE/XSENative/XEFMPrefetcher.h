@@ -0,0 +1,59 @@
+#pragma once
+
+#include "XGlobals.h"
+#include "XEFMMapping.h"
+
+#include <future>
+
+//    .
+struct XEFMPrefetchRange
+{
+	std::shared_ptr<const XEFMMapping> spMapping;
+	uint64_t                           nOffset;
+	uint64_t                           nSize;
+};
+
+/*
+
+    (XEFM::Prefetch()).       ,
+   --    .     
+ (PrefetchVirtualMemory:    ),      
+ ,    ,     .     --  
+      ,      .
+
+     ,   .     .
+
+*/
+
+class XEFMPrefetcher
+{
+private:
+	struct Job
+	{
+		std::vector<XEFMPrefetchRange> Ranges;
+		std::promise<void>             Done;
+	};
+
+	std::queue<Job>              m_Jobs;
+	std::mutex                   m_Lock;
+	std::condition_variable      m_cvJobs;
+	bool                         m_bStop;
+	std::unique_ptr<std::thread> m_spThread;
+
+	static void Prefetch(const XEFMPrefetchRange& range);
+
+	void ThreadPrefetch();
+
+public:
+	XEFMPrefetcher();
+
+	//  ,     .
+	~XEFMPrefetcher();
+
+	XEFMPrefetcher(const XEFMPrefetcher&) = delete;
+
+	XEFMPrefetcher& operator = (const XEFMPrefetcher&) = delete;
+
+	//    .  ,    .
+	std::future<void> Add(std::vector<XEFMPrefetchRange> ranges);
+};
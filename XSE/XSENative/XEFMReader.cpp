@@ -1,11 +1,19 @@
 #include "pch.h"
 #include "XEFMReader.h"
 #include "XEFM.h"
+#include "XEFMCodec.h"
 #include "XException.h"
 
 XEFMReader::XEFMReader()
 {
-
+	m_pData = nullptr;
+	m_nSize = 0;
+	m_nPos = 0;
+	m_pBlocks = nullptr;
+	m_nStoredSize = 0;
+	m_nBlockSize = 0;
+	m_nBlocks = 0;
+	m_nBlock = UINT32_MAX;
 }
 
 void XEFMReader::Open(const wchar_t* pFileName)
@@ -14,17 +22,46 @@ void XEFMReader::Open(const wchar_t* pFileName)
 
 	try
 	{
-		XEFM::Current().GetReaderInfo(pFileName, m_FileName, m_MinPos, m_MaxPos);
+		std::shared_ptr<const XEFMMapping> spMapping;
+		XEFMFileInfo info{ 0, 0, 0 };
+
+		XEFM::Current().GetReaderInfo(pFileName, spMapping, info);
+
+		if ((info.nOffset > spMapping->GetSize()) || (info.nSize > spMapping->GetSize() - info.nOffset))
+		{
+			throw XException(L"XEFMReader::Open(): file '%s' is out of storage bounds", pFileName);
+		}
 
-		m_Stream.open(m_FileName, std::ios::in | std::ios::binary);
+		const std::byte* pData = spMapping->GetData() + info.nOffset;
+		XEFMLZWIndexType index{ info.nSize, 0, 0 };
 
-		if (!m_Stream.is_open())
+		if (info.nFlags & XEFM_ENTRY_LZW)
 		{
-			throw XException(L"XEFMReader::Open(): can't open file '%s'", pFileName);
+			//  .     .
+			if (info.nSize < sizeof(XEFMLZWIndexType))
+			{
+				throw XException(L"XEFMReader::Open(): file '%s' is corrupted", pFileName);
+			}
+
+			memcpy(&index, pData, sizeof(XEFMLZWIndexType));
+
+			if ((!index.BlockSize) || ((index.Size + index.BlockSize - 1) / index.BlockSize != index.NumBlocks) ||
+				(sizeof(XEFMLZWIndexType) + (index.NumBlocks + 1ull) * sizeof(uint64_t) > info.nSize))
+			{
+				throw XException(L"XEFMReader::Open(): file '%s' is corrupted", pFileName);
+			}
 		}
 
-		m_CurPos = m_MinPos;
-		m_Stream.seekg(m_CurPos);
+		m_spMapping = std::move(spMapping);
+		m_pData = pData;
+		m_nSize = index.Size;
+		m_nPos = 0;
+		m_pBlocks = (info.nFlags & XEFM_ENTRY_LZW) ? pData + sizeof(XEFMLZWIndexType) : nullptr;
+		m_nStoredSize = info.nSize;
+		m_nBlockSize = index.BlockSize;
+		m_nBlocks = index.NumBlocks;
+		m_nBlock = UINT32_MAX;
+		m_Unpacked.clear();
 	}
 	catch (const XException& e)
 	{
@@ -36,7 +73,77 @@ void XEFMReader::Close()
 {
 	std::unique_lock lock{ m_Lock };
 
-	m_Stream.close();
+	m_spMapping.reset();
+	m_pData = nullptr;
+	m_nSize = 0;
+	m_nPos = 0;
+	m_pBlocks = nullptr;
+	m_nStoredSize = 0;
+	m_nBlockSize = 0;
+	m_nBlocks = 0;
+	m_nBlock = UINT32_MAX;
+	m_Block = std::vector<std::byte>();
+	m_Unpacked = std::vector<std::byte>();
+}
+
+uint64_t XEFMReader::GetBlockOffset(uint32_t nBlock) const
+{
+	uint64_t nOffset;
+
+	//     .
+	memcpy(&nOffset, m_pBlocks + (size_t)nBlock * sizeof(uint64_t), sizeof(uint64_t));
+
+	return nOffset;
+}
+
+void XEFMReader::UnpackBlock(uint32_t nBlock, std::byte* pDest, size_t nSize) const
+{
+	const uint64_t nBegin = GetBlockOffset(nBlock);
+	const uint64_t nEnd = GetBlockOffset(nBlock + 1);
+
+	if ((nBegin > nEnd) || (nEnd > m_nStoredSize) || (nEnd - nBegin > nSize))
+	{
+		throw XException(L"XEFMReader::UnpackBlock(): block %u is corrupted", nBlock);
+	}
+
+	if (nEnd - nBegin == nSize)
+	{
+		//    .
+		memcpy(pDest, m_pData + nBegin, nSize);
+	}
+	else
+	{
+		XEFMCodec::Decompress(m_pData + nBegin, (size_t)(nEnd - nBegin), pDest, nSize);
+	}
+}
+
+XEFMView XEFMReader::GetData(uint64_t nPos, size_t nCount) const
+{
+	if ((m_pBlocks == nullptr) || (!m_Unpacked.empty()))
+	{
+		const std::byte* pData = (m_pBlocks == nullptr) ? m_pData : m_Unpacked.data();
+
+		return XEFMView{ pData + nPos, (size_t)min((uint64_t)nCount, m_nSize - nPos) };
+	}
+
+	const uint32_t nBlock = (uint32_t)(nPos / m_nBlockSize);
+	const uint64_t nBlockBegin = (uint64_t)nBlock * m_nBlockSize;
+	const size_t   nBlockSize = (size_t)min((uint64_t)m_nBlockSize, m_nSize - nBlockBegin);
+
+	if (m_nBlock != nBlock)
+	{
+		//     :   ,      .
+		m_nBlock = UINT32_MAX;
+		m_Block.resize(nBlockSize);
+
+		UnpackBlock(nBlock, m_Block.data(), nBlockSize);
+
+		m_nBlock = nBlock;
+	}
+
+	const size_t nInBlock = (size_t)(nPos - nBlockBegin);
+
+	return XEFMView{ m_Block.data() + nInBlock, min(nCount, nBlockSize - nInBlock) };
 }
 
 
@@ -44,86 +151,60 @@ bool XEFMReader::IsOpen() const
 {
 	std::shared_lock lock{ m_Lock };
 
-	return m_Stream.is_open();
+	return m_spMapping != nullptr;
 }
 
 bool XEFMReader::IsEOF() const
 {
 	std::shared_lock lock{ m_Lock };
 
-	if (m_Stream.is_open())
-	{
-		return (m_CurPos > m_MaxPos);
-	}
-	else
-	{
-		//    --  EOF.
-		return true;
-	};
+	//    --  ,  EOF.
+	return (m_nPos >= m_nSize);
 }
 
 bool XEFMReader::ReadLine(std::string& s)
 {
 	std::unique_lock lock{ m_Lock };
 
-	if ((!m_Stream.is_open()) || (m_CurPos > m_MaxPos))
+	if (m_nPos >= m_nSize)
 	{
 		return false;
 	}
 
-	std::forward_list<char> listChars;
+	s.clear();
 
-	// '\r\n\' -   ,   
-	for (char c;;)
+	// '\r\n\' -   ,   .     .
+	while (m_nPos < m_nSize)
 	{
-		m_Stream.get(c);
-		m_CurPos++;
+		XEFMView view = GetData(m_nPos, SIZE_MAX);
 
-		if (c == '\r')
-		{
-			//  . ,   - '\n'. .
-			if (m_CurPos <= m_MaxPos)
-			{
-				m_Stream.get(c);
-				m_CurPos++;
-
-				if (c != '\n')
-				{
-					// ,  '\n'.    .
-					m_Stream.unget();
-					m_CurPos--;
-				};
-
-				break;
-			} 
-			else
-			{
-				//  , .
-				break;
-			}
-		}
-		else
-		if (c == '\n')
-		{
-			//  .
-			break;
+		const char* pBegin = reinterpret_cast<const char*>(view.pData);
+		const char* pEnd = pBegin + view.nSize;
+		const char* p = pBegin;
 
-		} else
+		while ((p != pEnd) && (*p != '\r') && (*p != '\n'))
 		{
-			//   ,  .
-			listChars.push_front(c);
+			++p;
 		}
 
-		if (m_CurPos > m_MaxPos)
+		s.append(pBegin, p);
+		m_nPos += (uint64_t)(p - pBegin);
+
+		if (p != pEnd)
 		{
-			// EOF.
+			//  .   '\r', ,   - '\n' (     
+			// );   .
+			++m_nPos;
+
+			if ((*p == '\r') && (m_nPos < m_nSize) && (*reinterpret_cast<const char*>(GetData(m_nPos, 1).pData) == '\n'))
+			{
+				++m_nPos;
+			}
+
 			break;
-		};
+		}
 	}
 
-	listChars.reverse();
-	s.assign(listChars.begin(), listChars.end());
-
 	return true;
 }
 
@@ -131,46 +212,40 @@ uint32_t XEFMReader::ReadBytes(char* pBuffer, const uint32_t nCount)
 {
 	std::unique_lock lock{ m_Lock };
 
-	if ((!m_Stream.is_open()) || (m_CurPos > m_MaxPos))
-	{
-		return 0;
-	}
+	uint32_t nRead{ 0 };
 
-	uint32_t bytes_allowed = min(nCount, (m_MaxPos - m_CurPos + 1));
-	uint32_t bytes_read{ 0 };
+	while ((nRead < nCount) && (m_nPos < m_nSize))
+	{
+		XEFMView view = GetData(m_nPos, nCount - nRead);
 
-	m_Stream.read(pBuffer, bytes_allowed);
-	bytes_read = (uint32_t)m_Stream.gcount();
+		memcpy(pBuffer + nRead, view.pData, view.nSize);
 
-	m_CurPos += bytes_read;
+		nRead += (uint32_t)view.nSize;
+		m_nPos += view.nSize;
+	}
 
-	return bytes_read;
+	return nRead;
 }
 
-uint32_t XEFMReader::Tell() const
+uint64_t XEFMReader::Tell() const
 {
 	std::shared_lock lock{ m_Lock };
 
-	if (!m_Stream.is_open())
-	{
-		return 0;
-	}
-
 	//  ,  0 - .
 
-	return (m_CurPos - m_MinPos);
+	return m_nPos;
 }
 
-bool XEFMReader::Seek(const uint32_t nPos, XSEEK_TYPE seektype)
+bool XEFMReader::Seek(const uint64_t nPos, XSEEK_TYPE seektype)
 {
 	std::unique_lock lock{ m_Lock };
 
-	if (!m_Stream.is_open())
+	if (m_spMapping == nullptr)
 	{
 		return false;
 	}
 
-	uint32_t nNewPos;
+	uint64_t nNewPos;
 
 	//       .
 	switch (seektype)
@@ -178,19 +253,19 @@ bool XEFMReader::Seek(const uint32_t nPos, XSEEK_TYPE seektype)
 	    case XSEEK_TYPE::XSEEK_BEGIN:
 	    {
 			//  .
-			nNewPos = nPos + m_MinPos;
+			nNewPos = nPos;
     		break;
 	    }
 	    case XSEEK_TYPE::XSEEK_CURRENT:
 	    {
 			//   .
-			nNewPos = nPos + m_CurPos;
+			nNewPos = nPos + m_nPos;
     		break;
     	}
 		case XSEEK_TYPE::XSEEK_END:
 		{
 			//  .
-			nNewPos = m_MaxPos - nPos;
+			nNewPos = m_nSize - 1 - nPos;
 			break;
 		}
     	default:
@@ -202,26 +277,56 @@ bool XEFMReader::Seek(const uint32_t nPos, XSEEK_TYPE seektype)
 	};
 
 	//      .
-	if ((nNewPos > m_MaxPos) || (nNewPos < m_MinPos))
+	if (nNewPos >= m_nSize)
 	{
 		return false;
 	}
 
-	//   .
-	m_Stream.seekg(nNewPos);
-	m_CurPos = nNewPos;
+	m_nPos = nNewPos;
 
 	return true;
 }
 
-uint32_t XEFMReader::GetSize() const
+uint64_t XEFMReader::GetSize() const
 {
 	std::shared_lock lock{ m_Lock };
 
-	if (!m_Stream.is_open())
+	return m_nSize;
+}
+
+XEFMView XEFMReader::GetView() const
+{
+	std::unique_lock lock{ m_Lock };
+
+	if ((m_pBlocks != nullptr) && (m_Unpacked.empty()) && (m_nSize))
+	{
+		std::vector<std::byte> unpacked((size_t)m_nSize);
+
+		for (uint32_t i = 0; i < m_nBlocks; ++i)
+		{
+			const uint64_t nBlockBegin = (uint64_t)i * m_nBlockSize;
+
+			UnpackBlock(i, unpacked.data() + nBlockBegin, (size_t)min((uint64_t)m_nBlockSize, m_nSize - nBlockBegin));
+		}
+
+		m_Unpacked = std::move(unpacked);
+	}
+
+	return XEFMView{ (m_pBlocks == nullptr) ? m_pData : m_Unpacked.data(), (size_t)m_nSize };
+}
+
+XEFMView XEFMReader::ReadView(const size_t nCount)
+{
+	std::unique_lock lock{ m_Lock };
+
+	if (m_nPos >= m_nSize)
 	{
-		return 0;
+		return XEFMView{};
 	}
 
-	return (m_MaxPos - m_MinPos + 1);
+	XEFMView view = GetData(m_nPos, nCount);
+
+	m_nPos += view.nSize;
+
+	return view;
 }
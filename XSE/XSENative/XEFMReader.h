@@ -1,21 +1,40 @@
 #pragma once
 
 #include "XGlobals.h"
+#include "XEFMMapping.h"
+#include "XEFMDirectory.h"
 
 class XEFMReader
 {
 private:
 
-	std::wstring  m_FileName; //  
-	uint32_t      m_MinPos;
-	uint32_t      m_MaxPos;
-	uint32_t      m_CurPos;
+	//   (  )     .
+	std::shared_ptr<const XEFMMapping> m_spMapping;
+	const std::byte*                   m_pData;
+	uint64_t                           m_nSize;       //  
+	uint64_t                           m_nPos;
+
+	//   (XEFMFormat.h): m_pData --    , m_pBlocks --  .
+	const std::byte*                   m_pBlocks;     // nullptr --   
+	uint64_t                           m_nStoredSize;
+	uint32_t                           m_nBlockSize;
+	uint32_t                           m_nBlocks;
+
+	//      ,     GetView().
+	mutable std::vector<std::byte>     m_Block;
+	mutable uint32_t                   m_nBlock;
+	mutable std::vector<std::byte>     m_Unpacked;
 
 	//   .
 	mutable std::shared_mutex m_Lock;
 
-	//  .
-	std::ifstream m_Stream;
+	uint64_t GetBlockOffset(uint32_t nBlock) const;
+
+	//    dest (nSize ).
+	void UnpackBlock(uint32_t nBlock, std::byte* pDest, size_t nSize) const;
+
+	//    nPos,   nCount       (  ).
+	XEFMView GetData(uint64_t nPos, size_t nCount) const;
 
 public:
 
@@ -40,10 +59,19 @@ public:
 
 	uint32_t ReadBytes(char* pBuffer, const uint32_t nCount);
 
-	uint32_t Tell() const;
+	uint64_t Tell() const;
+
+	bool Seek(const uint64_t nPos, XSEEK_TYPE seektype = XSEEK_TYPE::XSEEK_BEGIN);
+
+	uint64_t GetSize() const;
 
-	bool Seek(const uint32_t nPos, XSEEK_TYPE seektype = XSEEK_TYPE::XSEEK_BEGIN);
+	//     (  ).    Close() 
+	//  Open(); ,    .      .
+	XEFMView GetView() const;
 
-	uint32_t GetSize() const;
+	//  ,    ,   nCount ;  ,   ReadBytes().
+	//          (   nCount    )
+	//     .
+	XEFMView ReadView(const size_t nCount);
 };
 
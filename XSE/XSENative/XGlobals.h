@@ -19,6 +19,7 @@
 #include <cwctype>
 #include <any>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <iostream>
 #include <regex>
@@ -39,3 +40,4 @@
 #include <fstream>
 #include <locale>
 #include <limits>
+#include <chrono>
@@ -82,7 +82,7 @@ void XPCMDecoder::_OpenFile(const wchar_t* pFileName, bool bLoad)
 		case WAV_fmt:
 		{
 			//    ( ):
-			dwFormatOffset = reader.Tell();
+			dwFormatOffset = (DWORD)reader.Tell();
 			dwFormatLength = WaveChk.chkSize;
 
 			break;
@@ -90,7 +90,7 @@ void XPCMDecoder::_OpenFile(const wchar_t* pFileName, bool bLoad)
 		case WAV_data:
 		{
 			//   :
-			dwDataOffset = reader.Tell();
+			dwDataOffset = (DWORD)reader.Tell();
 			dwDataLength = WaveChk.chkSize;
 
 			break;
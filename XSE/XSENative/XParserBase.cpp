@@ -16,23 +16,36 @@ XParserElement::XParserElement(const std::initializer_list<XParserElement>& e)
 XParserElement::XParserElement(std::wregex begin, std::function<XParserHandler> beginHandler,
 	std::wregex end, std::function<XParserHandler> endHandler,
 	const std::initializer_list<XParserElement>& innerElements)
+	: XParserElement(std::make_shared<XRegexMatcher>(std::move(begin)), beginHandler,
+		std::make_shared<XRegexMatcher>(std::move(end)), endHandler, innerElements)
+{
+}
+
+XParserElement::XParserElement(std::wregex element, std::function<XParserHandler> handler)
+	: XParserElement(std::make_shared<XRegexMatcher>(std::move(element)), handler)
+{
+}
+
+XParserElement::XParserElement(std::shared_ptr<const XParserMatcher> begin, std::function<XParserHandler> beginHandler,
+	std::shared_ptr<const XParserMatcher> end, std::function<XParserHandler> endHandler,
+	const std::initializer_list<XParserElement>& innerElements)
 {
 	m_Type = XParserElementType::GroupElement;
 
-	m_RegexBegin = begin;
+	m_MatcherBegin = std::move(begin);
 	m_BeginHandler = beginHandler;
 
-	m_RegexEnd = end;
+	m_MatcherEnd = std::move(end);
 	m_EndHandler = endHandler;
 
 	m_ChildElements.assign(innerElements);
 }
 
-XParserElement::XParserElement(std::wregex element, std::function<XParserHandler> handler)
+XParserElement::XParserElement(std::shared_ptr<const XParserMatcher> element, std::function<XParserHandler> handler)
 {
 	m_Type = XParserElementType::SingleElement;
 
-	m_RegexBegin = element;
+	m_MatcherBegin = std::move(element);
 	m_BeginHandler = handler;
 }
 
@@ -40,8 +53,8 @@ XParserElement::XParserElement(const XParserElement& other)
 {
 	m_Type = other.m_Type;
 
-	m_RegexBegin = other.m_RegexBegin;
-	m_RegexEnd = other.m_RegexEnd;
+	m_MatcherBegin = other.m_MatcherBegin;
+	m_MatcherEnd = other.m_MatcherEnd;
 
 	m_BeginHandler = other.m_BeginHandler;
 	m_EndHandler = other.m_EndHandler;
@@ -53,8 +66,8 @@ XParserElement::XParserElement(XParserElement&& other)
 {
 	m_Type = std::exchange(other.m_Type, XParserElementType::EmptyElement);
 
-	m_RegexBegin = std::move(other.m_RegexBegin);
-	m_RegexEnd = std::move(other.m_RegexEnd);
+	m_MatcherBegin = std::move(other.m_MatcherBegin);
+	m_MatcherEnd = std::move(other.m_MatcherEnd);
 
 	m_BeginHandler = std::move(other.m_BeginHandler);
 	m_EndHandler = std::move(other.m_EndHandler);
@@ -68,8 +81,8 @@ XParserElement& XParserElement::operator = (const XParserElement& other)
 	{
 		m_Type = other.m_Type;
 
-		m_RegexBegin = other.m_RegexBegin;
-		m_RegexEnd = other.m_RegexEnd;
+		m_MatcherBegin = other.m_MatcherBegin;
+		m_MatcherEnd = other.m_MatcherEnd;
 
 		m_BeginHandler = other.m_BeginHandler;
 		m_EndHandler = other.m_EndHandler;
@@ -86,8 +99,8 @@ XParserElement& XParserElement::operator = (XParserElement&& other)
 	{
 		m_Type = std::exchange(other.m_Type, XParserElementType::EmptyElement);
 
-		m_RegexBegin = std::move(other.m_RegexBegin);
-		m_RegexEnd = std::move(other.m_RegexEnd);
+		m_MatcherBegin = std::move(other.m_MatcherBegin);
+		m_MatcherEnd = std::move(other.m_MatcherEnd);
 
 		m_BeginHandler = std::move(other.m_BeginHandler);
 		m_EndHandler = std::move(other.m_EndHandler);
@@ -98,6 +111,48 @@ XParserElement& XParserElement::operator = (XParserElement&& other)
 	return *this;
 }
 
+XParserLineIterator::XParserLineIterator(std::wstring_view text, std::wstring_view comment)
+	: m_pNext(text.data()), m_pEnd(text.data() + text.size()), m_Comment(comment)
+{
+	Advance();
+}
+
+void XParserLineIterator::Advance()
+{
+	if ((!m_pNext) || (m_pNext == m_pEnd))
+	{
+		//      .
+		m_pNext = nullptr;
+		m_Line = std::wstring_view();
+
+		return;
+	}
+
+	const wchar_t* pLineEnd = m_pNext;
+
+	while ((pLineEnd != m_pEnd) && (*pLineEnd != L'\r') && (*pLineEnd != L'\n'))
+	{
+		++pLineEnd;
+	}
+
+	m_Line = std::wstring_view(m_pNext, pLineEnd - m_pNext);
+
+	if (m_Comment.size())
+	{
+		m_Line = m_Line.substr(0, m_Line.find(m_Comment));
+	}
+
+	m_pNext = pLineEnd;
+
+	if (m_pNext != m_pEnd)
+	{
+		if ((*m_pNext++ == L'\r') && (m_pNext != m_pEnd) && (*m_pNext == L'\n'))
+		{
+			++m_pNext;
+		}
+	}
+}
+
 XStringParser::XStringParser()
 {
 
@@ -108,3 +163,7 @@ void XStringParser::Init(const std::initializer_list<XParserElement> &e)
 	m_RootElement = XParserElement(e);
 }
 
+void XStringParser::ParseBuffer(std::wstring_view text, std::wstring_view comment) const
+{
+	Parse(XParserLineIterator(text, comment), XParserLineIterator());
+}
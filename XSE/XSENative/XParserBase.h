@@ -2,6 +2,7 @@
 
 #include "XGlobals.h"
 #include "XException.h"
+#include "XParserMatcher.h"
 
 // Element types.
 enum XParserElementType : int
@@ -14,7 +15,7 @@ enum XParserElementType : int
 
 class XStringParser;
 
-using XParserHandler = bool(const XStringParser&, const std::wsmatch&);
+using XParserHandler = bool(const XStringParser&, const XParserMatch&);
 
 struct XParserElement
 {
@@ -22,8 +23,8 @@ struct XParserElement
 
 private:
 	XParserElementType            m_Type;          //  
-	std::wregex                   m_RegexBegin;    //      
-	std::wregex                   m_RegexEnd;      //    
+	std::shared_ptr<const XParserMatcher> m_MatcherBegin; //     
+	std::shared_ptr<const XParserMatcher> m_MatcherEnd;   //   
 
 	std::function<XParserHandler> m_BeginHandler;  //   
 	std::function<XParserHandler> m_EndHandler;    //   
@@ -41,6 +42,13 @@ public:
 
 	XParserElement(std::wregex element, std::function<XParserHandler> handler);
 
+	//     (. XParserMatcher::Create())    XParserMatcher.
+	XParserElement(std::shared_ptr<const XParserMatcher> begin, std::function<XParserHandler> beginHandler,
+		std::shared_ptr<const XParserMatcher> end, std::function<XParserHandler> endHandler,
+		const std::initializer_list<XParserElement>& innerElements);
+
+	XParserElement(std::shared_ptr<const XParserMatcher> element, std::function<XParserHandler> handler);
+
 	XParserElement(const XParserElement& other);
 
 	XParserElement(XParserElement&& other);
@@ -51,6 +59,60 @@ public:
 
 };
 
+//       .   -- "\r\n", "\r"  "\n" ( 
+// XEFMReader::ReadLine()),  --    .    ,
+//    . ,   , -- .
+class XParserLineIterator
+{
+private:
+	const wchar_t*    m_pNext;    //   , nullptr -- 
+	const wchar_t*    m_pEnd;
+	std::wstring_view m_Line;
+	std::wstring_view m_Comment;
+
+	void Advance();
+
+public:
+	using iterator_category = std::forward_iterator_tag;
+	using value_type = std::wstring_view;
+	using difference_type = std::ptrdiff_t;
+	using pointer = const std::wstring_view*;
+	using reference = const std::wstring_view&;
+
+	XParserLineIterator() : m_pNext(nullptr), m_pEnd(nullptr)
+	{
+	}
+
+	explicit XParserLineIterator(std::wstring_view text, std::wstring_view comment = std::wstring_view());
+
+	reference operator * () const { return m_Line; }
+
+	pointer operator -> () const { return &m_Line; }
+
+	XParserLineIterator& operator ++ ()
+	{
+		Advance();
+
+		return *this;
+	}
+
+	XParserLineIterator operator ++ (int)
+	{
+		XParserLineIterator it = *this;
+
+		Advance();
+
+		return it;
+	}
+
+	bool operator == (const XParserLineIterator& other) const
+	{
+		return (m_pNext == other.m_pNext) && (m_Line.data() == other.m_Line.data());
+	}
+
+	bool operator != (const XParserLineIterator& other) const { return !(*this == other); }
+};
+
 class XStringParser
 {
 private:
@@ -62,37 +124,56 @@ public:
 	//     .
 	void Init(const std::initializer_list<XParserElement>& e);
 
-	//       .
+	//        ( "(\s)*"  std::wregex).
+	static bool IsBlankLine(std::wstring_view s)
+	{
+		for (wchar_t c : s)
+		{
+			if (!std::iswspace(c))
+				return false;
+		}
+
+		return true;
+	}
+
+	//      (. XParserLineIterator).      
+	//   text,     .
+	void ParseBuffer(std::wstring_view text, std::wstring_view comment = std::wstring_view()) const;
+
+	//       .   -- ,  
+	//  std::wstring_view (std::wstring, std::wstring_view, const wchar_t*),   .
+	//     ,     (std::list)  
+	//  .
 	template <typename IT>
 	void Parse(IT itbegin, IT itend) const
 	{
 		std::stack<const XParserElement*> es; // ,      
-		uint32_t line{ 0 };;                  //      
+		uint32_t line{ 0 };                   //      
 
 
 		es.push(&m_RootElement);
 
-		std::wsmatch base_match;
+		XParserMatch match;                   // ,      
 		bool processed;
-		typename IT::value_type s;
 
 		for (IT it = itbegin; it != itend; ++it)
 		{
-			s = *it;
-			line = (uint32_t)(std::distance(itbegin, it)) + 1;
+			std::wstring_view s = *it;
+
+			++line;
 			processed = false;
 
 			//       .
-			if ( (std::regex_match(s, base_match, std::wregex(L"(\\s)*"))) || (s == L"") )
+			if (IsBlankLine(s))
 				continue;
 
 			for (auto &e : es.top()->m_ChildElements)
 			{
-				if (std::regex_match(s, base_match, e.m_RegexBegin))
+				if (e.m_MatcherBegin->Match(s, match))
 				{
 					try
 					{
-						e.m_BeginHandler(*this, base_match);
+						e.m_BeginHandler(*this, match);
 					}
 					catch (const std::bad_function_call& e)
 					{
@@ -120,12 +201,12 @@ public:
 			if ((es.top()->m_Type == XParserElementType::GroupElement) && (!processed))
 			{
 				//      ?
-				if (std::regex_match(s, base_match, es.top()->m_RegexEnd))
+				if (es.top()->m_MatcherEnd->Match(s, match))
 				{
 					try
 					{
 						processed = true;
-						es.top()->m_EndHandler(*this, base_match);
+						es.top()->m_EndHandler(*this, match);
 					}
 					catch (const std::bad_function_call& e)
 					{
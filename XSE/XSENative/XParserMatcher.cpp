@@ -0,0 +1,48 @@
+#include "pch.h"
+#include "XParserMatcher.h"
+
+XParserMatch::XParserMatch()
+{
+}
+
+const std::wcsub_match& XParserMatch::operator[](size_t n) const
+{
+	return (n < m_Groups.size()) ? m_Groups[n] : m_Unmatched;
+}
+
+XRegexMatcher::XRegexMatcher(const std::wstring& pattern, bool bCaseless)
+	: m_Regex(pattern, bCaseless ? (std::regex_constants::ECMAScript | std::regex_constants::icase) : std::regex_constants::ECMAScript),
+	m_strPattern(pattern), m_bCaseless(bCaseless)
+{
+}
+
+XRegexMatcher::XRegexMatcher(std::wregex regex) : m_Regex(std::move(regex)), m_bCaseless(false)
+{
+}
+
+bool XRegexMatcher::Match(std::wstring_view s, XParserMatch& match) const
+{
+	if (!std::regex_match(s.data(), s.data() + s.size(), match.m_RegexMatch, m_Regex))
+	{
+		return false;
+	}
+
+	match.m_Groups.assign(match.m_RegexMatch.begin(), match.m_RegexMatch.end());
+
+	return true;
+}
+
+std::shared_ptr<const XParserMatcher> XParserMatcher::Create(const std::wstring& pattern, bool bCaseless, XParserEngine engine)
+{
+	if (engine == XParserEngine::Dfa)
+	{
+		auto spMatcher = std::make_shared<XDfaMatcher>(pattern, bCaseless);
+
+		if (spMatcher->IsValid())
+		{
+			return spMatcher;
+		}
+	}
+
+	return std::make_shared<XRegexMatcher>(pattern, bCaseless);
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "XGlobals.h"
+#include "../../auxCode/auxCode/auxDfaEngine.h"
+
+//   :  0 --  , 1..N --  .
+//   std::match_results,      match[1].str().
+// view()     --    ,   .
+class XParserMatch
+{
+	friend class XRegexMatcher;
+	friend class XDfaMatcher;
+
+private:
+	std::vector<std::wcsub_match> m_Groups;      // 
+	std::wcsub_match              m_Unmatched;   //      
+	std::wcmatch                  m_RegexMatch;  //  std::regex_match ( XRegexMatcher)
+
+	//   ,   ,     .
+	std::vector<size_t>           m_Scratch;
+
+public:
+	XParserMatch();
+
+	size_t size() const { return m_Groups.size(); }
+
+	bool empty() const { return m_Groups.empty(); }
+
+	const std::wcsub_match& operator[](size_t n) const;
+
+	std::wstring str(size_t n = 0) const { return (*this)[n].str(); }
+
+	size_t length(size_t n = 0) const { return (*this)[n].length(); }
+
+	std::wstring_view view(size_t n = 0) const
+	{
+		const std::wcsub_match& g = (*this)[n];
+
+		return (g.matched) ? std::wstring_view(g.first, g.second - g.first) : std::wstring_view();
+	}
+};
+
+//  :
+enum class XParserEngine : int
+{
+	Regex = 0,  // std::wregex   
+	Dfa = 1     // XDfaMatcher, std::wregex     
+};
+
+//     .
+class XParserMatcher
+{
+public:
+	virtual ~XParserMatcher() {}
+
+	//   TRUE,     ;    match.
+	virtual bool Match(std::wstring_view s, XParserMatch& match) const = 0;
+
+	//   ( ,  ).
+	virtual const std::wstring& GetPattern() const = 0;
+
+	virtual bool IsCaseless() const = 0;
+
+	//         .
+	static std::shared_ptr<const XParserMatcher> Create(const std::wstring& pattern, bool bCaseless = false,
+		XParserEngine engine = XParserEngine::Dfa);
+};
+
+//  std::wregex:   ECMAScript,   .
+class XRegexMatcher : public XParserMatcher
+{
+private:
+	std::wregex   m_Regex;
+	std::wstring  m_strPattern;
+	bool          m_bCaseless;
+
+public:
+	XRegexMatcher(const std::wstring& pattern, bool bCaseless = false);
+
+	//   .
+	XRegexMatcher(std::wregex regex);
+
+	bool Match(std::wstring_view s, XParserMatch& match) const override;
+
+	const std::wstring& GetPattern() const override { return m_strPattern; }
+
+	bool IsCaseless() const override { return m_bCaseless; }
+};
+
+//     ,    : aux::DfaEngine
+// (auxDfaEngine.h)  wchar_t.      ,  --   
+//   .
+class XDfaMatcher : public XParserMatcher
+{
+public:
+	//    ,      .
+	static constexpr uint32_t MAX_STATES = aux::DfaEngine<wchar_t>::MAX_STATES;
+
+private:
+	std::wstring            m_strPattern;
+	bool                    m_bCaseless;
+	aux::DfaEngine<wchar_t> m_Engine;
+
+public:
+	XDfaMatcher(const std::wstring& pattern, bool bCaseless = false)
+		: m_strPattern(pattern), m_bCaseless(bCaseless), m_Engine(pattern, bCaseless)
+	{
+	}
+
+	// FALSE,     ; Match()    FALSE.
+	bool IsValid() const { return m_Engine.IsValid(); }
+
+	bool Match(std::wstring_view s, XParserMatch& match) const override
+	{
+		return m_Engine.Match(s, match.m_Scratch, match.m_Groups);
+	}
+
+	const std::wstring& GetPattern() const override { return m_strPattern; }
+
+	bool IsCaseless() const override { return m_bCaseless; }
+};
@@ -49,6 +49,42 @@ int XSEObject::CreateStorage(const wchar_t* pDir, const wchar_t* pStorage)
 	return 0;
 }
 
+int XSEObject::UpdateStorage(const wchar_t* pDir, const wchar_t* pStorage)
+{
+	std::unique_lock lock{ m_mtxLock };
+
+	try
+	{
+		XEFM::UpdateStorage(pDir, pStorage);
+	}
+	catch (XException& e)
+	{
+		m_strLastError = e.GetDumpInfo();
+
+		return -1;
+	}
+
+	return 0;
+}
+
+int XSEObject::CompactStorage(const wchar_t* pStorage)
+{
+	std::unique_lock lock{ m_mtxLock };
+
+	try
+	{
+		XEFM::CompactStorage(pStorage);
+	}
+	catch (XException& e)
+	{
+		m_strLastError = e.GetDumpInfo();
+
+		return -1;
+	}
+
+	return 0;
+}
+
 const wchar_t* XSEObject::GetLastError() const
 {
 	std::shared_lock lock{ m_mtxLock };
@@ -141,6 +177,54 @@ int XSEObject::Done()
 	return 0;
 }
 
+int XSEObject::MountStorage(const wchar_t* pStorage, int32_t nPriority)
+{
+	std::unique_lock lock{ m_mtxLock };
+
+	if (m_bInit)
+	{
+		try
+		{
+			XEFM::Current().Mount(pStorage, nPriority);
+		}
+		catch (XException& e)
+		{
+			m_strLastError = e.GetDumpInfo();
+			return -1;
+		}
+
+		return 0;
+	}
+
+	m_strLastError = pNotInitializedError;
+
+	return -1;
+}
+
+int XSEObject::UnmountStorage(const wchar_t* pStorage)
+{
+	std::unique_lock lock{ m_mtxLock };
+
+	if (m_bInit)
+	{
+		try
+		{
+			XEFM::Current().Unmount(pStorage);
+		}
+		catch (XException& e)
+		{
+			m_strLastError = e.GetDumpInfo();
+			return -1;
+		}
+
+		return 0;
+	}
+
+	m_strLastError = pNotInitializedError;
+
+	return -1;
+}
+
 int XSEObject::Suspend()
 {
 	std::unique_lock lock{ m_mtxLock };
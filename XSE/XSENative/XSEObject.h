@@ -53,6 +53,14 @@ public:
 	
 	int CreateStorage(const wchar_t* pDir, const wchar_t* pStorage);
 
+	int UpdateStorage(const wchar_t* pDir, const wchar_t* pStorage);
+
+	int CompactStorage(const wchar_t* pStorage);
+
+	int MountStorage(const wchar_t* pStorage, int32_t nPriority);
+
+	int UnmountStorage(const wchar_t* pStorage);
+
 	const wchar_t* GetLastError() const;
 
 	int GetLastErrorInfo(wchar_t *pBuffer, int nSize);
@@ -180,11 +180,11 @@ XSoundBankParser::XSoundBankParser()
 
 	XStringParser::Init(
 		{
-			XParserElement(std::wregex(L"\\s*<soundbank>\\s*", std::regex_constants::ECMAScript | std::regex_constants::icase), nullptr, std::wregex(L"\\s*</soundbank>", std::regex_constants::ECMAScript | std::regex_constants::icase), nullptr,
+			XParserElement(XParserMatcher::Create(L"\\s*<soundbank>\\s*", true), nullptr, XParserMatcher::Create(L"\\s*</soundbank>", true), nullptr,
 			{
-				XParserElement(std::wregex(L"\\s*<filelist>\\s*", std::regex_constants::ECMAScript | std::regex_constants::icase), nullptr, std::wregex(L"\\s*</filelist>", std::regex_constants::ECMAScript | std::regex_constants::icase), nullptr,
+				XParserElement(XParserMatcher::Create(L"\\s*<filelist>\\s*", true), nullptr, XParserMatcher::Create(L"\\s*</filelist>", true), nullptr,
 					{
-						XParserElement(std::wregex(L"\\s*<file (.*)\\/>\\s*", std::regex_constants::ECMAScript | std::regex_constants::icase), &FILE_Handler)
+						XParserElement(XParserMatcher::Create(L"\\s*<file (.*)\\/>\\s*", true), &FILE_Handler)
 					})
 			})
 		});
@@ -195,10 +195,6 @@ void XSoundBankParser::Parse(const wchar_t* pFileName, std::list<XSoundBankEntry
 {
 	XEFMReader reader;
 
-	//          ID.
-	m_pDestList = pDest;
-	m_usetId.clear();
-
 	try
 	{
 		reader.Open(pFileName);
@@ -209,31 +205,24 @@ void XSoundBankParser::Parse(const wchar_t* pFileName, std::list<XSoundBankEntry
 		throw XException(e, L"XSoundBank::XSoundBankParser::Parse(): can't open file");
 	};
 
-	std::string line;
-	std::list<std::wstring> listStrings;
-
-	//    .
-	while (!reader.IsEOF())
-	{
-		reader.ReadLine(line);
-
-		std::wstring wline{ line.cbegin(), line.cend() };
-
-		//   --    ,  .
-		auto nSlashPos = wline.find(L"//");
+	//        ,     .
+	XEFMView view = reader.GetView();
 
-		if (nSlashPos != -1)
-		{
-			wline = wline.substr(0, nSlashPos);
-		}
+	std::wstring text{ reinterpret_cast<const char*>(view.begin()), reinterpret_cast<const char*>(view.end()) };
 
-		listStrings.emplace_back(wline);
+	Parse(text, pDest);
+}
 
-	};
+void XSoundBankParser::Parse(std::wstring_view text, std::list<XSoundBankEntry>* pDest)
+{
+	//          ID.
+	m_pDestList = pDest;
+	m_usetId.clear();
 
 	try
 	{
-		XStringParser::Parse(listStrings.begin(), listStrings.end());
+		//   --    .
+		XStringParser::ParseBuffer(text, L"//");
 	}
 	catch (const XException& e)
 	{
@@ -242,6 +231,61 @@ void XSoundBankParser::Parse(const wchar_t* pFileName, std::list<XSoundBankEntry
 
 }
 
+void XSoundBankParser::Benchmark(std::wostream& os, uint32_t nLines)
+{
+	std::wstring text;
+	uint32_t nCount{ 0 };
+
+	auto add_line = [&text, &nCount](const std::wstring& s)
+	{
+		text += s;
+		text += L"\r\n";
+		++nCount;
+	};
+
+	add_line(L"<soundbank>");
+	add_line(L"    <filelist>");
+
+	//     ,     ; ID ,
+	//     0x10000.
+	for (uint32_t n = 0; nCount + 2 < nLines; ++n)
+	{
+		uint32_t nId = n / 2;
+
+		if ((n & 1) || (nId > 0xFFFF))
+		{
+			add_line((n % 3 == 0) ? L"" : ((n % 3 == 1) ? L"        \t " : L"        // "));
+			continue;
+		}
+
+		std::wstring s = L"        <file name = \"sound_" + std::to_wstring(nId) + L".wav\" id = " + std::to_wstring(nId)
+			+ ((nId % 3) ? L" type = \"fetch\"" : L" type = \"stream\"");
+
+		if (nId % 5 == 0)
+		{
+			s += L" description = \"entry " + std::to_wstring(nId) + L"\"";
+		}
+
+		add_line(s + L" />");
+	}
+
+	add_line(L"    </filelist>");
+	add_line(L"</soundbank>");
+
+	XSoundBankParser parser;
+	std::list<XSoundBankEntry> entries;
+
+	auto t0 = std::chrono::steady_clock::now();
+
+	parser.Parse(text, &entries);
+
+	auto t1 = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(t1 - t0).count();
+
+	os << L"lines: " << nCount << L", entries: " << entries.size() << L", seconds: " << seconds
+		<< L", lines/s: " << static_cast<uint64_t>(nCount / seconds) << std::endl;
+}
+
 
 // <FILE ... ... /> 
 // :
@@ -250,7 +294,7 @@ void XSoundBankParser::Parse(const wchar_t* pFileName, std::list<XSoundBankEntry
 // type (STRING)         -   (fetch / stream), 
 // description (STRING)  - , 
 
-bool XSoundBankParser::FILE_Handler(const XStringParser& obj, const std::wsmatch& match)
+bool XSoundBankParser::FILE_Handler(const XStringParser& obj, const XParserMatch& match)
 {
 	XSoundBankParser& p = (XSoundBankParser&)const_cast<XStringParser&>(obj);
 
@@ -259,7 +303,7 @@ bool XSoundBankParser::FILE_Handler(const XStringParser& obj, const std::wsmatch
 	XTagAttribute attrType{ L"TYPE", XTagAttributeType::TYPE_STRING, true, std::make_any<XTagAttribute::STRING_TYPE>() };
 	XTagAttribute attrDescription{ L"DESCRIPTION", XTagAttributeType::TYPE_STRING, false, std::make_any<XTagAttribute::STRING_TYPE>(L"") };
 
-	std::wstring strAttributes = match[1];
+	std::wstring_view strAttributes = match.view(1);
 
 	try
 	{
@@ -317,7 +361,7 @@ bool XSoundBankParser::FILE_Handler(const XStringParser& obj, const std::wsmatch
 	return true;
 }
 
-void XSoundBankParser::ParseAttributes(const std::wstring s, std::initializer_list<XTagAttribute*> AttrList)
+void XSoundBankParser::ParseAttributes(std::wstring_view s, std::initializer_list<XTagAttribute*> AttrList)
 {
 	std::wstring strChunk{};
 	wchar_t      cCurrent;
@@ -78,11 +78,18 @@ public:
 	XSoundBankParser();
 	void Parse(const wchar_t* pFileName, std::list<XSoundBankEntry>* pDest);
 
+	//   ,    .
+	void Parse(std::wstring_view text, std::list<XSoundBankEntry>* pDest);
+
+	//   :    nLines  (,  , 
+	//    )   ,  os  ,      .
+	static void Benchmark(std::wostream& os, uint32_t nLines = 100000);
+
 
 private:
 	
-	static bool FILE_Handler(const XStringParser& obj, const std::wsmatch& match);
-	static void ParseAttributes(const std::wstring s, std::initializer_list<XTagAttribute*> AttrList);
+	static bool FILE_Handler(const XStringParser& obj, const XParserMatch& match);
+	static void ParseAttributes(std::wstring_view s, std::initializer_list<XTagAttribute*> AttrList);
 
 };
 
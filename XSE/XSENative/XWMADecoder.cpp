@@ -35,7 +35,12 @@ void XWMADecoder::_OpenFile(const wchar_t* pFileName, uint8_t Mode)
 		throw XException(e, L"XWMADecoder()::_OpenFile(): can't open file '%s'", pFileName);
 	}
 
-	std::uint32_t nFileSize = reader.GetSize();
+	if (reader.GetSize() > UINT32_MAX)
+	{
+		throw XException(L"XWMADecoder()::_OpenFile(): file '%s' is too large", pFileName);
+	}
+
+	std::uint32_t nFileSize = (std::uint32_t)reader.GetSize();
 
 	//    :
 	HGLOBAL hGH = GlobalAlloc(GMEM_MOVEABLE | GMEM_NODISCARD, nFileSize);
@@ -6,6 +6,26 @@ _declspec(dllexport) int XSECreateStorage(const wchar_t* pDir, const wchar_t* pS
 	return XSEObject::Current().CreateStorage(pDir, pStorage);
 }
 
+_declspec(dllexport) int XSEUpdateStorage(const wchar_t* pDir, const wchar_t* pStorage)
+{
+	return XSEObject::Current().UpdateStorage(pDir, pStorage);
+}
+
+_declspec(dllexport) int XSECompactStorage(const wchar_t* pStorage)
+{
+	return XSEObject::Current().CompactStorage(pStorage);
+}
+
+_declspec(dllexport) int XSEMountStorage(const wchar_t* pStorage, int32_t nPriority)
+{
+	return XSEObject::Current().MountStorage(pStorage, nPriority);
+}
+
+_declspec(dllexport) int XSEUnmountStorage(const wchar_t* pStorage)
+{
+	return XSEObject::Current().UnmountStorage(pStorage);
+}
+
 _declspec(dllexport) wchar_t* XSEGetLastError()
 {
 	return const_cast<wchar_t*>(XSEObject::Current().GetLastError());
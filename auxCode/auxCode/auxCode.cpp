@@ -6,8 +6,13 @@
 #include <algorithm>
 #include <numeric>
 #include "auxLogger.h"
+#include "auxLoggerBenchmark.h"
 #include "auxParser.h"
 #include "auxPathMatrix.h"
+#include "auxPathBenchmark.h"
+#include "auxKeyBenchmark.h"
+#include "auxParserBenchmark.h"
+#include "auxStaticParser.h"
 
 class CustomParser : public aux::StringParser
 {
@@ -31,45 +36,103 @@ public:
 	void Parse()
 	{
 		Init({
-			aux::ParserElement(std::regex("<sphere>"), nullptr, std::regex("</sphere>"), nullptr,
+			aux::ParserElement("<sphere>", nullptr, "</sphere>", nullptr,
 				{
-					aux::ParserElement(std::regex("<radius = ([\\d]+)>"), RadiusHandler)
+					aux::ParserElement("<radius = ([\\d]+)>", RadiusHandler)
 				}),
 			
-			aux::ParserElement(std::regex("<box>"), nullptr, std::regex("</box>"), nullptr,
+			aux::ParserElement("<box>", nullptr, "</box>", nullptr,
 				{
-					aux::ParserElement(std::regex("<size = ([\\d]+)>"), SizeHandler)
+					aux::ParserElement("<size = ([\\d]+)>", SizeHandler)
 				})
 			});
 
-		std::vector<std::string> file{
-		"<sphere>", 
-		"<radius = 10>",
-		"</sphere>",
-		"<box>",
-		"<size = 45>",
-		"</box>"
-		};
+		const char* pFile =
+			"<sphere>\r\n"
+			"<radius = 10>\r\n"
+			"</sphere>\r\n"
+			"<box>\r\n"
+			"<size = 45>\r\n"
+			"</box>\r\n";
 
-		StringParser::Parse(file.cbegin(), file.cend());
+		StringParser::ParseBuffer(pFile);
 
 	}
 
-	static bool RadiusHandler(const StringParser& obj, const std::smatch& match)
+	static bool RadiusHandler(const StringParser& obj, const aux::ParserMatch& match)
 	{
-		std::cout << "Radius: " << match[1].str() << "\n";
+		std::cout << "Radius: " << match.view(1) << "\n";
 
 		return true;
 	}
 
-	static bool SizeHandler(const StringParser& obj, const std::smatch& match)
+	static bool SizeHandler(const StringParser& obj, const aux::ParserMatch& match)
 	{
-		std::cout << "Size: " << match[1].str() << "\n";
+		std::cout << "Size: " << match.view(1) << "\n";
 
 		return true;
 	}
 };
 
+// Same grammar declared at compile time: no grammar is built at run time, handlers are called directly.
+namespace StaticScene
+{
+	struct Scene
+	{
+		int nObjects{ 0 };
+	};
+
+	struct RadiusHandler
+	{
+		bool operator () (Scene& scene, const aux::ParserMatch& match) const
+		{
+			std::cout << "Radius: " << match.view(1) << "\n";
+			++scene.nObjects;
+
+			return true;
+		}
+	};
+
+	struct SizeHandler
+	{
+		bool operator () (Scene& scene, const aux::ParserMatch& match) const
+		{
+			std::cout << "Size: " << match.view(1) << "\n";
+			++scene.nObjects;
+
+			return true;
+		}
+	};
+
+	constexpr char SphereBegin[] = "<sphere>";
+	constexpr char SphereEnd[] = "</sphere>";
+	constexpr char Radius[] = "<radius = ([\\d]+)>";
+	constexpr char BoxBegin[] = "<box>";
+	constexpr char BoxEnd[] = "</box>";
+	constexpr char Size[] = "<size = ([\\d]+)>";
+
+	using Parser = aux::StaticParser<Scene,
+		aux::StaticGroup<SphereBegin, aux::ParserNoHandler, SphereEnd, aux::ParserNoHandler,
+			aux::StaticElement<Radius, RadiusHandler>>,
+		aux::StaticGroup<BoxBegin, aux::ParserNoHandler, BoxEnd, aux::ParserNoHandler,
+			aux::StaticElement<Size, SizeHandler>>>;
+
+	void Parse()
+	{
+		Scene scene;
+
+		Parser().ParseBuffer(scene,
+			"<sphere>\r\n"
+			"<radius = 10>\r\n"
+			"</sphere>\r\n"
+			"<box>\r\n"
+			"<size = 45>\r\n"
+			"</box>\r\n");
+
+		std::cout << "Objects: " << scene.nObjects << "\n";
+	}
+}
+
 int main()
 {
 	/*
@@ -79,6 +142,8 @@ int main()
 
 	aux::Logger::Get() << aux::Logger::Get().Now() << ": Testing logger\n";
 
+	AUX_LOG(Info, "{}: Testing logger at level {}\n", aux::LoggerTime::Now(), aux::Logger::GetLevel());
+
 	*/
 
 	/*
@@ -138,6 +203,33 @@ int main()
 		std::cout << "No path." << std::endl;
 	}
 	*/
+
+	/*
+	aux::PathBenchmark(std::cout);
+	*/
+
+	/*
+	auxKeyGeneratorBenchmark(std::cout);
+	*/
+
+	/*
+	aux::ParserBenchmark(std::cout);
+	*/
+
+	/*
+	aux::LoggerBenchmark(std::cout);
+	*/
+
+	/*
+	std::ifstream binaryLog("e:\\log.bin", std::ios::binary);
+
+	aux::DecodeLog(binaryLog, std::cout);
+	*/
+
+	/*
+	StaticScene::Parse();
+	*/
+
 	CustomParser().Parse();
 
 }
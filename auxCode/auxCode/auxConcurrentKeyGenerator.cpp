@@ -0,0 +1,654 @@
+#include "auxConcurrentKeyGenerator.h"
+
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+	// Index of the lowest set bit (w must not be 0).
+	inline uint32_t LowestBit(uint64_t w)
+	{
+#if defined(_MSC_VER)
+		unsigned long idx;
+#if defined(_M_X64) || defined(_M_ARM64)
+		_BitScanForward64(&idx, w);
+
+		return idx;
+#else
+		if (_BitScanForward(&idx, static_cast<unsigned long>(w)))
+		{
+			return idx;
+		}
+
+		_BitScanForward(&idx, static_cast<unsigned long>(w >> 32));
+
+		return idx + 32;
+#endif
+#else
+		return static_cast<uint32_t>(__builtin_ctzll(w));
+#endif
+	}
+
+	constexpr size_t NO_WORD = static_cast<size_t>(-1);
+}
+
+struct auxConcurrentKeyGenerator::Bitmap
+{
+	// Keys cached by one thread: a stack of slots (1-based keys, 0 - empty). Only the owner puts keys
+	// in, any thread may take them out with an exchange, so keys of idle threads can be reclaimed.
+	// Blocks live as long as the bitmap and are reused after their thread exits.
+	struct CacheBlock
+	{
+		std::atomic<bool>                        bUsed{ true };
+		std::unique_ptr<std::atomic<uint32_t>[]> upSlots;
+		CacheBlock*                              pNext{ nullptr };
+	};
+
+	// m_vecLevels[0] - leaf words (one bit per key index), m_vecLevels.back() - a single top word.
+	std::vector<std::unique_ptr<std::atomic<uint64_t>[]>> m_vecLevels;
+	std::vector<size_t>                                   m_vecWords;
+	std::unique_ptr<std::atomic<uint64_t>[]>              m_upAllocated;  // one bit per key index, 1 = owned by a caller
+	std::atomic<CacheBlock*>                              m_pCaches{ nullptr };
+	uint32_t                                              m_nCacheSlots;
+
+	Bitmap(uint32_t nKeys, uint32_t nCacheSlots) : m_nCacheSlots(nCacheSlots)
+	{
+		size_t nWords = std::max<size_t>(1, (static_cast<size_t>(nKeys) + 63) / 64);
+
+		// Leaves: all keys are free, bits past nKeys stay 0.
+		m_vecLevels.emplace_back(new std::atomic<uint64_t>[nWords]);
+		m_vecWords.push_back(nWords);
+		m_upAllocated.reset(new std::atomic<uint64_t>[nWords]);
+
+		for (size_t i = 0; i < nWords; ++i)
+		{
+			size_t nFirst = i * 64;
+			size_t nBits = std::min<size_t>(64, (nKeys > nFirst) ? (nKeys - nFirst) : 0);
+
+			m_vecLevels[0][i].store((nBits == 64) ? ~0ull : ((1ull << nBits) - 1), std::memory_order_relaxed);
+			m_upAllocated[i].store(0, std::memory_order_relaxed);
+		}
+
+		// Summary levels up to a single word.
+		while (nWords > 1)
+		{
+			size_t nParentWords = (nWords + 63) / 64;
+			auto& child = m_vecLevels.back();
+
+			std::unique_ptr<std::atomic<uint64_t>[]> parent{ new std::atomic<uint64_t>[nParentWords] };
+
+			for (size_t i = 0; i < nParentWords; ++i)
+			{
+				uint64_t w{ 0 };
+
+				for (size_t k = 0; (k < 64) && (i * 64 + k < nWords); ++k)
+				{
+					if (child[i * 64 + k].load(std::memory_order_relaxed))
+					{
+						w |= (1ull << k);
+					}
+				}
+
+				parent[i].store(w, std::memory_order_relaxed);
+			}
+
+			m_vecLevels.push_back(std::move(parent));
+			m_vecWords.push_back(nParentWords);
+
+			nWords = nParentWords;
+		}
+	}
+
+	~Bitmap()
+	{
+		for (CacheBlock* pBlock = m_pCaches.load(std::memory_order_acquire); pBlock; )
+		{
+			CacheBlock* pNext = pBlock->pNext;
+
+			delete pBlock;
+			pBlock = pNext;
+		}
+	}
+
+	// Walks down the lowest hint bits to a leaf word. Returns NO_WORD if nothing is free.
+	size_t FindLeaf()
+	{
+		const size_t nTop = m_vecLevels.size() - 1;
+
+		for (;;)
+		{
+			size_t pos{ 0 };
+			bool   bStale{ false };
+
+			for (size_t level = nTop; level > 0; --level)
+			{
+				uint64_t w = m_vecLevels[level][pos].load(std::memory_order_acquire);
+
+				if (!w)
+				{
+					if (level == nTop)
+					{
+						// Top says "empty". Hints may lag behind a concurrent free, so check the leaves.
+						if (!Repair())
+						{
+							return NO_WORD;
+						}
+					}
+					else
+					{
+						// Parent hint was stale: drop it.
+						ClearUp(level, pos);
+					}
+
+					bStale = true;
+					break;
+				}
+
+				pos = pos * 64 + LowestBit(w);
+			}
+
+			if (!bStale)
+			{
+				return pos;
+			}
+		}
+	}
+
+	// Claims up to nCount free indexes from one leaf word (ascending). Returns how many were claimed.
+	uint32_t Claim(uint32_t* pIndexes, uint32_t nCount)
+	{
+		for (;;)
+		{
+			size_t pos = FindLeaf();
+
+			if (pos == NO_WORD)
+			{
+				return 0;
+			}
+
+			auto& leaf = m_vecLevels[0][pos];
+			uint64_t w = leaf.load(std::memory_order_acquire);
+
+			while (w)
+			{
+				uint64_t take{ 0 }, rest{ w };
+				uint32_t n{ 0 };
+
+				for (; (rest) && (n < nCount); ++n)
+				{
+					take |= (rest & (~rest + 1));
+					rest &= (rest - 1);
+				}
+
+				if (leaf.compare_exchange_weak(w, w & ~take, std::memory_order_acq_rel, std::memory_order_acquire))
+				{
+					for (uint32_t k = 0; k < n; ++k)
+					{
+						pIndexes[k] = static_cast<uint32_t>(pos * 64 + LowestBit(take));
+						take &= (take - 1);
+					}
+
+					if (!rest)
+					{
+						// Took the last free bits of the word.
+						ClearUp(0, pos);
+					}
+
+					return n;
+				}
+			}
+
+			if (m_vecLevels.size() == 1)
+			{
+				// Single word and it's empty.
+				return 0;
+			}
+
+			ClearUp(0, pos);
+		}
+	}
+
+	uint32_t Allocate(uint32_t* pIndexes, uint32_t nCount)
+	{
+		uint32_t nDone{ 0 };
+
+		while (nDone < nCount)
+		{
+			uint32_t n = Claim(pIndexes + nDone, nCount - nDone);
+
+			if (!n)
+			{
+				break;
+			}
+
+			nDone += n;
+		}
+
+		return nDone;
+	}
+
+	// Sets free bits in a leaf word. Returns the bits that were already free (double free).
+	uint64_t Release(size_t pos, uint64_t mask)
+	{
+		uint64_t old = m_vecLevels[0][pos].fetch_or(mask, std::memory_order_acq_rel);
+
+		MarkUp(pos);
+
+		return (old & mask);
+	}
+
+	// Leaf word pos got free bits: make sure every hint on the way up is set.
+	void MarkUp(size_t pos)
+	{
+		for (size_t level = 0; level + 1 < m_vecLevels.size(); ++level)
+		{
+			auto& parent = m_vecLevels[level + 1][pos / 64];
+			uint64_t bit{ 1ull << (pos % 64) };
+
+			if (!(parent.load(std::memory_order_acquire) & bit))
+			{
+				parent.fetch_or(bit, std::memory_order_acq_rel);
+			}
+
+			pos /= 64;
+		}
+	}
+
+	// Word pos at the given level was seen empty: clear its hint, going up while parents become empty.
+	void ClearUp(size_t level, size_t pos)
+	{
+		while (level + 1 < m_vecLevels.size())
+		{
+			auto& parent = m_vecLevels[level + 1][pos / 64];
+			uint64_t bit{ 1ull << (pos % 64) };
+
+			uint64_t old = parent.fetch_and(~bit, std::memory_order_acq_rel);
+
+			if (m_vecLevels[level][pos].load(std::memory_order_acquire))
+			{
+				// Refilled by a concurrent free in the meantime: put the hint back.
+				parent.fetch_or(bit, std::memory_order_acq_rel);
+				return;
+			}
+
+			if (old & ~bit)
+			{
+				return;
+			}
+
+			++level;
+			pos /= 64;
+		}
+	}
+
+	// Slow path used when the top word is empty: finds a non-empty leaf and restores its hints.
+	bool Repair()
+	{
+		for (size_t i = 0; i < m_vecWords[0]; ++i)
+		{
+			if (m_vecLevels[0][i].load(std::memory_order_acquire))
+			{
+				MarkUp(i);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// Frees 1-based keys, grouped by leaf word. Returns false if any key was already free.
+	bool FreeKeys(const uint32_t* pKeys, size_t nCount)
+	{
+		std::vector<uint32_t> vecIndexes(nCount);
+
+		for (size_t i = 0; i < nCount; ++i)
+		{
+			vecIndexes[i] = pKeys[i] - 1;
+		}
+
+		std::sort(vecIndexes.begin(), vecIndexes.end());
+
+		bool bOK{ true };
+		size_t i{ 0 };
+
+		while (i < vecIndexes.size())
+		{
+			size_t pos = vecIndexes[i] / 64;
+			uint64_t mask{ 0 };
+
+			for (; (i < vecIndexes.size()) && (vecIndexes[i] / 64 == pos); ++i)
+			{
+				mask |= (1ull << (vecIndexes[i] % 64));
+			}
+
+			if (Release(pos, mask))
+			{
+				bOK = false;
+			}
+		}
+
+		return bOK;
+	}
+
+	void SetAllocated(uint32_t index)
+	{
+		m_upAllocated[index / 64].fetch_or(1ull << (index % 64), std::memory_order_relaxed);
+	}
+
+	// Returns false if the key was not allocated (double free).
+	bool ClearAllocated(uint32_t index)
+	{
+		uint64_t bit{ 1ull << (index % 64) };
+
+		return (m_upAllocated[index / 64].fetch_and(~bit, std::memory_order_acq_rel) & bit) != 0;
+	}
+
+	// A free block for the calling thread, a new one if all are used.
+	CacheBlock* AcquireCache()
+	{
+		for (CacheBlock* pBlock = m_pCaches.load(std::memory_order_acquire); pBlock; pBlock = pBlock->pNext)
+		{
+			bool bUsed{ false };
+
+			if ((!pBlock->bUsed.load(std::memory_order_relaxed)) &&
+				(pBlock->bUsed.compare_exchange_strong(bUsed, true, std::memory_order_acquire)))
+			{
+				return pBlock;
+			}
+		}
+
+		CacheBlock* pBlock = new CacheBlock;
+
+		pBlock->upSlots.reset(new std::atomic<uint32_t>[m_nCacheSlots]);
+
+		for (uint32_t i = 0; i < m_nCacheSlots; ++i)
+		{
+			pBlock->upSlots[i].store(0, std::memory_order_relaxed);
+		}
+
+		pBlock->pNext = m_pCaches.load(std::memory_order_relaxed);
+
+		while (!m_pCaches.compare_exchange_weak(pBlock->pNext, pBlock, std::memory_order_release, std::memory_order_relaxed))
+		{
+		}
+
+		return pBlock;
+	}
+
+	// Moves the keys of slots [nBegin, nEnd) of a block back to the bitmap, returns how many.
+	size_t Drain(CacheBlock* pBlock, uint32_t nBegin, uint32_t nEnd)
+	{
+		std::vector<uint32_t> vecKeys;
+
+		for (uint32_t i = nBegin; i < nEnd; ++i)
+		{
+			if (uint32_t key = pBlock->upSlots[i].exchange(0, std::memory_order_acquire))
+			{
+				vecKeys.push_back(key);
+			}
+		}
+
+		FreeKeys(vecKeys.data(), vecKeys.size());
+
+		return vecKeys.size();
+	}
+
+	// The bitmap is empty: takes the keys cached by all threads back. Returns how many.
+	size_t Reclaim()
+	{
+		size_t nKeys{ 0 };
+
+		for (CacheBlock* pBlock = m_pCaches.load(std::memory_order_acquire); pBlock; pBlock = pBlock->pNext)
+		{
+			nKeys += Drain(pBlock, 0, m_nCacheSlots);
+		}
+
+		return nKeys;
+	}
+};
+
+namespace
+{
+	// Per-thread key caches, one entry per generator the thread has used.
+	struct ThreadKeyCache
+	{
+		struct Entry
+		{
+			std::weak_ptr<auxConcurrentKeyGenerator::Bitmap> wpBitmap;
+			auxConcurrentKeyGenerator::Bitmap::CacheBlock*   pBlock;
+			uint32_t                                         nKeys;  // slots in use, some may have been reclaimed (0)
+		};
+
+		std::vector<Entry>    m_vecEntries;
+		std::vector<uint32_t> m_vecBatch;
+		size_t                m_nLast{ 0 };
+
+		~ThreadKeyCache()
+		{
+			// Thread exits: give the keys and the blocks back to generators that are still alive.
+			for (auto& e : m_vecEntries)
+			{
+				if (auto spBitmap = e.wpBitmap.lock())
+				{
+					spBitmap->Drain(e.pBlock, 0, e.nKeys);
+					e.pBlock->bUsed.store(false, std::memory_order_release);
+				}
+			}
+		}
+
+		static bool SameOwner(const Entry& e, const std::shared_ptr<auxConcurrentKeyGenerator::Bitmap>& spBitmap)
+		{
+			// The weak pointer keeps the control block alive, so equal owners mean the same generator.
+			return (!e.wpBitmap.owner_before(spBitmap)) && (!spBitmap.owner_before(e.wpBitmap));
+		}
+
+		Entry* Find(const std::shared_ptr<auxConcurrentKeyGenerator::Bitmap>& spBitmap)
+		{
+			if ((m_nLast < m_vecEntries.size()) && (SameOwner(m_vecEntries[m_nLast], spBitmap)))
+			{
+				return &m_vecEntries[m_nLast];
+			}
+
+			for (size_t i = 0; i < m_vecEntries.size(); ++i)
+			{
+				if (SameOwner(m_vecEntries[i], spBitmap))
+				{
+					m_nLast = i;
+					return &m_vecEntries[i];
+				}
+			}
+
+			return nullptr;
+		}
+
+		Entry& Get(const std::shared_ptr<auxConcurrentKeyGenerator::Bitmap>& spBitmap)
+		{
+			if (Entry* pEntry = Find(spBitmap))
+			{
+				return *pEntry;
+			}
+
+			// Drop entries of destroyed generators (their blocks went with them) before adding a new one.
+			m_vecEntries.erase(std::remove_if(m_vecEntries.begin(), m_vecEntries.end(),
+				[](const Entry& e) { return e.wpBitmap.expired(); }), m_vecEntries.end());
+
+			m_vecEntries.push_back(Entry{ spBitmap, spBitmap->AcquireCache(), 0 });
+			m_nLast = m_vecEntries.size() - 1;
+
+			return m_vecEntries.back();
+		}
+	};
+
+	thread_local ThreadKeyCache t_KeyCache;
+}
+
+auxConcurrentKeyGenerator::auxConcurrentKeyGenerator(uint32_t nMaxKeys, uint32_t nCacheSize)
+{
+	m_nMaxKeys = nMaxKeys;
+
+	// A thread caches at most 2 * nCacheSize keys, 1/32 of the pool; small pools get no caches.
+	m_nCacheSize = std::min(nCacheSize, nMaxKeys / 64);
+	m_spBitmap = std::make_shared<Bitmap>(nMaxKeys, 2 * m_nCacheSize);
+}
+
+auxConcurrentKeyGenerator::~auxConcurrentKeyGenerator()
+{
+	// Keys cached by other threads are dropped when those threads see the generator expired.
+}
+
+bool auxConcurrentKeyGenerator::Allocate(uint32_t& key)
+{
+	uint32_t index;
+
+	if (m_nCacheSize)
+	{
+		auto& e = t_KeyCache.Get(m_spBitmap);
+
+		while (e.nKeys)
+		{
+			// The slot is empty if another thread reclaimed the key.
+			if (uint32_t k = e.pBlock->upSlots[--e.nKeys].exchange(0, std::memory_order_acquire))
+			{
+				m_spBitmap->SetAllocated(k - 1);
+				key = k;
+
+				return true;
+			}
+		}
+
+		// Refill the cache with one batch from the bitmap: the lowest key to the caller, the rest
+		// on the stack, lowest on top.
+		auto& vecBatch = t_KeyCache.m_vecBatch;
+
+		vecBatch.resize(m_nCacheSize);
+
+		if (uint32_t n = m_spBitmap->Allocate(vecBatch.data(), m_nCacheSize))
+		{
+			for (uint32_t i = n - 1; i > 0; --i)
+			{
+				e.pBlock->upSlots[e.nKeys++].store(vecBatch[i] + 1, std::memory_order_release);
+			}
+
+			m_spBitmap->SetAllocated(vecBatch[0]);
+			key = vecBatch[0] + 1;
+
+			return true;
+		}
+	}
+
+	// The bitmap is empty: keys cached by other threads are taken back before giving up.
+	do
+	{
+		if (m_spBitmap->Allocate(&index, 1))
+		{
+			m_spBitmap->SetAllocated(index);
+			key = index + 1;
+
+			return true;
+		}
+	}
+	while (m_spBitmap->Reclaim());
+
+	return false;
+}
+
+uint32_t auxConcurrentKeyGenerator::AllocateBatch(uint32_t* pKeys, uint32_t nCount)
+{
+	// Batches go straight to the bitmap: one CAS per leaf word already amortizes the cost.
+	uint32_t n = m_spBitmap->Allocate(pKeys, nCount);
+
+	while ((n < nCount) && (m_spBitmap->Reclaim()))
+	{
+		n += m_spBitmap->Allocate(pKeys + n, nCount - n);
+	}
+
+	for (uint32_t i = 0; i < n; ++i)
+	{
+		m_spBitmap->SetAllocated(pKeys[i]);
+		pKeys[i]++;
+	}
+
+	return n;
+}
+
+bool auxConcurrentKeyGenerator::Free(uint32_t key)
+{
+	if ((!key) || (key > m_nMaxKeys) || (!m_spBitmap->ClearAllocated(key - 1)))
+	{
+		return false;
+	}
+
+	if (!m_nCacheSize)
+	{
+		return !m_spBitmap->Release((key - 1) / 64, 1ull << ((key - 1) % 64));
+	}
+
+	auto& e = t_KeyCache.Get(m_spBitmap);
+
+	if (e.nKeys == 2 * m_nCacheSize)
+	{
+		// Cache is full: return the upper half.
+		m_spBitmap->Drain(e.pBlock, m_nCacheSize, e.nKeys);
+		e.nKeys = m_nCacheSize;
+	}
+
+	e.pBlock->upSlots[e.nKeys++].store(key, std::memory_order_release);
+
+	return true;
+}
+
+bool auxConcurrentKeyGenerator::FreeBatch(const uint32_t* pKeys, uint32_t nCount)
+{
+	// Out of range and not allocated keys are skipped, the rest is freed.
+	std::vector<uint32_t> vecKeys;
+	bool bOK{ true };
+
+	vecKeys.reserve(nCount);
+
+	for (uint32_t i = 0; i < nCount; ++i)
+	{
+		if ((pKeys[i]) && (pKeys[i] <= m_nMaxKeys) && (m_spBitmap->ClearAllocated(pKeys[i] - 1)))
+		{
+			vecKeys.push_back(pKeys[i]);
+		}
+		else
+		{
+			bOK = false;
+		}
+	}
+
+	m_spBitmap->FreeKeys(vecKeys.data(), vecKeys.size());
+
+	return bOK;
+}
+
+void auxConcurrentKeyGenerator::FlushCache()
+{
+	if (auto pEntry = t_KeyCache.Find(m_spBitmap); (pEntry) && (pEntry->nKeys))
+	{
+		m_spBitmap->Drain(pEntry->pBlock, 0, pEntry->nKeys);
+		pEntry->nKeys = 0;
+	}
+}
+
+auxConcurrentKeyGenerator& auxConcurrentKeyGenerator::operator >> (uint32_t& key)
+{
+	if (!Allocate(key))
+	{
+		key = 0;
+	}
+
+	return *this;
+}
+
+auxConcurrentKeyGenerator& auxConcurrentKeyGenerator::operator << (uint32_t key)
+{
+	Free(key);
+
+	return *this;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+// Thread-safe replacement for auxKeyGenerator.
+//
+// Keys are 1..nMaxKeys (0 is never a valid key). Free keys are tracked by a hierarchical
+// atomic bitmap: leaf words hold one bit per key (1 = free), every upper level holds one bit
+// per word of the level below (1 = that word may have free keys). Allocation walks down the
+// lowest set bits and claims a leaf bit with a CAS, so without thread caches the lowest free
+// key is returned. No locks are taken anywhere.
+//
+// When nCacheSize > 0 every thread keeps up to 2 * nCacheSize free keys of its own, refilled and
+// drained in batches of nCacheSize, so most calls never touch the shared bitmap. nCacheSize is cut
+// to nMaxKeys / 64, small pools have no caches. Cached keys are returned to the bitmap by
+// FlushCache() or when the thread exits; when the bitmap runs empty, Allocate() takes back the
+// keys cached by all threads, so it fails only if every key is allocated.
+//
+// Every key has an "allocated" bit, so a double free is rejected before the key reaches a cache.
+
+class auxConcurrentKeyGenerator
+{
+public:
+	struct Bitmap;
+
+private:
+	std::shared_ptr<Bitmap> m_spBitmap;
+	uint32_t                m_nMaxKeys;
+	uint32_t                m_nCacheSize;
+
+public:
+	auxConcurrentKeyGenerator(uint32_t nMaxKeys, uint32_t nCacheSize = 32);
+	~auxConcurrentKeyGenerator();
+
+	auxConcurrentKeyGenerator(const auxConcurrentKeyGenerator&) = delete;
+	auxConcurrentKeyGenerator& operator = (const auxConcurrentKeyGenerator&) = delete;
+
+	// Returns false when no keys are left.
+	bool Allocate(uint32_t& key);
+
+	// Allocates up to nCount keys, returns how many were stored to pKeys.
+	uint32_t AllocateBatch(uint32_t* pKeys, uint32_t nCount);
+
+	// Returns false for keys out of range or keys not allocated.
+	bool Free(uint32_t key);
+
+	// Returns false if any of the keys was rejected, the other keys are freed.
+	bool FreeBatch(const uint32_t* pKeys, uint32_t nCount);
+
+	// Returns keys cached by the calling thread to the shared bitmap.
+	void FlushCache();
+
+	// Same interface as auxKeyGenerator. Sets key to 0 when no keys are left.
+	auxConcurrentKeyGenerator& operator >> (uint32_t& key);
+
+	auxConcurrentKeyGenerator& operator << (uint32_t key);
+
+	uint32_t GetMaxKeys() const { return m_nMaxKeys; }
+};
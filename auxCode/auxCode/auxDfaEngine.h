@@ -0,0 +1,1106 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cwctype>
+#include <functional>
+#include <map>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace aux
+{
+	// Character type of DfaEngine: the range of the codes and the class functions.
+	template <typename Char>
+	struct DfaCharTraits;
+
+	template <>
+	struct DfaCharTraits<char>
+	{
+		static constexpr uint32_t MAX_CHAR = 0xFF;
+
+		static uint32_t Code(char c) { return static_cast<unsigned char>(c); }
+
+		static uint32_t ToLower(uint32_t c) { return static_cast<uint32_t>(std::tolower(static_cast<int>(c))); }
+
+		static uint32_t ToUpper(uint32_t c) { return static_cast<uint32_t>(std::toupper(static_cast<int>(c))); }
+
+		static bool IsAlnum(uint32_t c) { return std::isalnum(static_cast<int>(c)) != 0; }
+	};
+
+	template <>
+	struct DfaCharTraits<wchar_t>
+	{
+		static constexpr uint32_t MAX_CHAR = 0xFFFF;  // UTF-16
+
+		static uint32_t Code(wchar_t c) { return static_cast<uint32_t>(static_cast<std::make_unsigned_t<wchar_t>>(c)); }
+
+		static uint32_t ToLower(uint32_t c) { return static_cast<uint32_t>(std::towlower(static_cast<wint_t>(c))); }
+
+		static uint32_t ToUpper(uint32_t c) { return static_cast<uint32_t>(std::towupper(static_cast<wint_t>(c))); }
+
+		static bool IsAlnum(uint32_t c) { return std::iswalnum(static_cast<wint_t>(c)) != 0; }
+	};
+
+	// Table-driven DFA engine for the subset of the syntax the grammars use:
+	// literals and escaped metacharacters, '.', classes [a-z] [^...], \s \S \d \D \w \W,
+	// capturing (...) and non-capturing (?:...) groups, '|', '*', '+', '?' (and lazy '*?' ...),
+	// '^' at the start and '$' at the end.
+	//
+	// Characters are mapped to equivalence classes (every character of a class behaves the same in
+	// every set of the pattern), the DFA is one transition table over these classes, built eagerly
+	// by subset construction. Matching is one table load per character. Groups are recovered only
+	// after a successful match, by backtracking over the same program in the order std::regex
+	// tries the alternatives (so the groups are the same), with every (instruction, position)
+	// pair tried at most once. Both passes are linear in the line length and work in the memory
+	// passed by the caller.
+	//
+	// The one known difference to std::regex: groups inside a repeated subpattern that can match
+	// the empty string ("(a?)*") may get other values; whether the line matches is the same.
+	//
+	// Shared by DfaMatcher (char) and XDfaMatcher of XSE (wchar_t).
+	template <typename Char, typename Traits = DfaCharTraits<Char>>
+	class DfaEngine
+	{
+	public:
+		using View = std::basic_string_view<Char>;
+		using Groups = std::vector<std::sub_match<const Char*>>;
+
+		// Upper bound for the number of DFA states, larger patterns run on the backtracking pass alone.
+		static constexpr uint32_t MAX_STATES = 4096;
+
+	private:
+		using Ranges = std::vector<std::pair<uint32_t, uint32_t>>;  // inclusive character ranges
+
+		static constexpr uint32_t MAX_CHAR = Traits::MAX_CHAR;
+		static constexpr size_t   NO_POS = static_cast<size_t>(-1);
+
+		enum class Op : uint8_t
+		{
+			Set,    // consume a character of set nArg
+			Split,  // continue at nArg (preferred) and nArg2
+			Jump,   // continue at nArg
+			Save,   // store position into slot nArg
+			Accept
+		};
+
+		struct Instruction
+		{
+			Op       Code;
+			uint32_t nArg;
+			uint32_t nArg2;
+		};
+
+		enum class PatternKind : uint8_t
+		{
+			Empty,
+			Set,        // nArg - set index
+			Concat,
+			Alternate,
+			Star,
+			Plus,
+			Quest,
+			Group       // nArg - group number
+		};
+
+		struct PatternNode
+		{
+			PatternKind           Kind;
+			uint32_t              nArg;
+			bool                  bGreedy;
+			std::vector<uint32_t> Children;
+		};
+
+		static void Normalize(Ranges& ranges)
+		{
+			std::sort(ranges.begin(), ranges.end());
+
+			size_t n = 0;
+
+			for (size_t i = 0; i < ranges.size(); ++i)
+			{
+				if ((n) && (ranges[i].first <= ranges[n - 1].second + 1))
+				{
+					ranges[n - 1].second = std::max(ranges[n - 1].second, ranges[i].second);
+				}
+				else
+				{
+					ranges[n++] = ranges[i];
+				}
+			}
+
+			ranges.resize(n);
+		}
+
+		static Ranges Complement(Ranges ranges)
+		{
+			Normalize(ranges);
+
+			Ranges result;
+			uint32_t next = 0;
+
+			for (auto& r : ranges)
+			{
+				if (r.first > next)
+				{
+					result.emplace_back(next, r.first - 1);
+				}
+
+				next = r.second + 1;
+			}
+
+			if (next <= MAX_CHAR)
+			{
+				result.emplace_back(next, MAX_CHAR);
+			}
+
+			return result;
+		}
+
+		// Recursive descent parser of the pattern into a syntax tree and a list of character sets.
+		class PatternParser
+		{
+		private:
+			const std::basic_string<Char>& m_s;
+			size_t                         m_nPos;
+			bool                           m_bCaseless;
+
+		public:
+			std::vector<PatternNode> Nodes;
+			std::vector<Ranges>      Sets;
+			uint32_t                 nGroups;
+			bool                     bError;
+
+			PatternParser(const std::basic_string<Char>& s, bool bCaseless) : m_s(s), m_nPos(0), m_bCaseless(bCaseless), nGroups(1), bError(false)
+			{
+			}
+
+			// Root of the tree, bError is set for syntax outside of the subset.
+			uint32_t Parse()
+			{
+				uint32_t root = ParseAlternate();
+
+				if (m_nPos < m_s.size())
+				{
+					// Unbalanced ')'.
+					bError = true;
+				}
+
+				return root;
+			}
+
+		private:
+			bool IsEnd() const { return (m_nPos >= m_s.size()); }
+
+			uint32_t Peek() const { return Traits::Code(m_s[m_nPos]); }
+
+			uint32_t AddNode(PatternKind kind, uint32_t nArg = 0)
+			{
+				Nodes.push_back(PatternNode{ kind, nArg, true, {} });
+
+				return static_cast<uint32_t>(Nodes.size() - 1);
+			}
+
+			uint32_t AddSet(Ranges ranges)
+			{
+				if (m_bCaseless)
+				{
+					Ranges folded;
+
+					for (auto& r : ranges)
+					{
+						for (uint32_t c = r.first; c <= r.second; ++c)
+						{
+							uint32_t lower = Traits::ToLower(c);
+							uint32_t upper = Traits::ToUpper(c);
+
+							if (lower != c)
+							{
+								folded.emplace_back(lower, lower);
+							}
+
+							if (upper != c)
+							{
+								folded.emplace_back(upper, upper);
+							}
+						}
+					}
+
+					ranges.insert(ranges.end(), folded.cbegin(), folded.cend());
+				}
+
+				Normalize(ranges);
+				Sets.push_back(std::move(ranges));
+
+				return AddNode(PatternKind::Set, static_cast<uint32_t>(Sets.size() - 1));
+			}
+
+			uint32_t ParseAlternate()
+			{
+				uint32_t node = ParseConcat();
+
+				if ((IsEnd()) || (Peek() != '|'))
+				{
+					return node;
+				}
+
+				uint32_t alternate = AddNode(PatternKind::Alternate);
+
+				Nodes[alternate].Children.push_back(node);
+
+				while ((!IsEnd()) && (Peek() == '|'))
+				{
+					++m_nPos;
+
+					node = ParseConcat();
+					Nodes[alternate].Children.push_back(node);
+				}
+
+				return alternate;
+			}
+
+			uint32_t ParseConcat()
+			{
+				uint32_t concat = AddNode(PatternKind::Concat);
+
+				while ((!IsEnd()) && (Peek() != '|') && (Peek() != ')') && (!bError))
+				{
+					uint32_t node = ParseRepeat();
+
+					Nodes[concat].Children.push_back(node);
+				}
+
+				return concat;
+			}
+
+			uint32_t ParseRepeat()
+			{
+				uint32_t atom = ParseAtom();
+
+				if (IsEnd())
+				{
+					return atom;
+				}
+
+				PatternKind kind;
+
+				switch (Peek())
+				{
+				case '*': kind = PatternKind::Star; break;
+				case '+': kind = PatternKind::Plus; break;
+				case '?': kind = PatternKind::Quest; break;
+				case '{': bError = true; return atom;
+				default: return atom;
+				}
+
+				++m_nPos;
+
+				uint32_t repeat = AddNode(kind);
+
+				Nodes[repeat].Children.push_back(atom);
+
+				if ((!IsEnd()) && (Peek() == '?'))
+				{
+					Nodes[repeat].bGreedy = false;
+					++m_nPos;
+				}
+
+				if ((!IsEnd()) && ((Peek() == '*') || (Peek() == '+') || (Peek() == '?') || (Peek() == '{')))
+				{
+					bError = true;
+				}
+
+				return repeat;
+			}
+
+			uint32_t ParseAtom()
+			{
+				uint32_t c = Peek();
+
+				++m_nPos;
+
+				switch (c)
+				{
+				case '(':
+				{
+					uint32_t nGroup = 0;
+
+					if ((!IsEnd()) && (Peek() == '?'))
+					{
+						// Only (?:...), lookaheads are not supported.
+						if ((m_nPos + 1 >= m_s.size()) || (Traits::Code(m_s[m_nPos + 1]) != ':'))
+						{
+							bError = true;
+							return AddNode(PatternKind::Empty);
+						}
+
+						m_nPos += 2;
+					}
+					else
+					{
+						nGroup = nGroups++;
+					}
+
+					uint32_t inner = ParseAlternate();
+
+					if ((IsEnd()) || (Peek() != ')'))
+					{
+						bError = true;
+						return inner;
+					}
+
+					++m_nPos;
+
+					if (!nGroup)
+					{
+						return inner;
+					}
+
+					uint32_t group = AddNode(PatternKind::Group, nGroup);
+
+					Nodes[group].Children.push_back(inner);
+
+					return group;
+				}
+
+				case '[':
+					return ParseClass();
+
+				case '.':
+					return AddSet(Complement({ { '\n', '\n' }, { '\r', '\r' } }));
+
+				case '\\':
+				{
+					Ranges ranges;
+
+					if ((IsEnd()) || (!ParseEscape(ranges)))
+					{
+						bError = true;
+					}
+
+					return AddSet(ranges);
+				}
+
+				case '^':
+					// Anchors mean nothing for a whole-line match, but only at the ends of the pattern.
+					if (m_nPos != 1)
+					{
+						bError = true;
+					}
+
+					return AddNode(PatternKind::Empty);
+
+				case '$':
+					if (!IsEnd())
+					{
+						bError = true;
+					}
+
+					return AddNode(PatternKind::Empty);
+
+				case ')': case '*': case '+': case '?': case '{': case '}': case ']':
+					bError = true;
+					return AddNode(PatternKind::Empty);
+
+				default:
+					return AddSet({ { c, c } });
+				}
+			}
+
+			// Escape after '\' into ranges, FALSE for escapes outside of the subset (\b, \1, \x, ...).
+			bool ParseEscape(Ranges& ranges)
+			{
+				uint32_t c = Peek();
+
+				++m_nPos;
+
+				switch (c)
+				{
+				case 'd': ranges = { { '0', '9' } }; return true;
+				case 'D': ranges = Complement({ { '0', '9' } }); return true;
+				case 's': ranges = { { '\t', '\r' }, { ' ', ' ' } }; return true;
+				case 'S': ranges = Complement({ { '\t', '\r' }, { ' ', ' ' } }); return true;
+				case 'w': ranges = { { '0', '9' }, { 'A', 'Z' }, { '_', '_' }, { 'a', 'z' } }; return true;
+				case 'W': ranges = Complement({ { '0', '9' }, { 'A', 'Z' }, { '_', '_' }, { 'a', 'z' } }); return true;
+				case 't': ranges = { { '\t', '\t' } }; return true;
+				case 'n': ranges = { { '\n', '\n' } }; return true;
+				case 'r': ranges = { { '\r', '\r' } }; return true;
+				case 'v': ranges = { { '\v', '\v' } }; return true;
+				case 'f': ranges = { { '\f', '\f' } }; return true;
+				}
+
+				if (Traits::IsAlnum(c))
+				{
+					return false;
+				}
+
+				ranges = { { c, c } };
+
+				return true;
+			}
+
+			uint32_t ParseClass()
+			{
+				Ranges ranges;
+				bool bNegate = false;
+
+				if ((!IsEnd()) && (Peek() == '^'))
+				{
+					bNegate = true;
+					++m_nPos;
+				}
+
+				while ((!IsEnd()) && (Peek() != ']'))
+				{
+					uint32_t first = Peek();
+
+					++m_nPos;
+
+					if (first == '\\')
+					{
+						Ranges escape;
+
+						if ((IsEnd()) || (!ParseEscape(escape)))
+						{
+							bError = true;
+							return AddNode(PatternKind::Empty);
+						}
+
+						if ((escape.size() != 1) || (escape[0].first != escape[0].second))
+						{
+							// \d, \s, \w, ... can't start a range.
+							ranges.insert(ranges.end(), escape.cbegin(), escape.cend());
+							continue;
+						}
+
+						first = escape[0].first;
+					}
+
+					uint32_t last = first;
+
+					if ((m_nPos + 1 < m_s.size()) && (Peek() == '-') && (Traits::Code(m_s[m_nPos + 1]) != ']'))
+					{
+						++m_nPos;
+
+						last = Peek();
+						++m_nPos;
+
+						if (last == '\\')
+						{
+							Ranges escape;
+
+							if ((IsEnd()) || (!ParseEscape(escape)) || (escape.size() != 1) || (escape[0].first != escape[0].second))
+							{
+								bError = true;
+								return AddNode(PatternKind::Empty);
+							}
+
+							last = escape[0].first;
+						}
+
+						if (last < first)
+						{
+							bError = true;
+							return AddNode(PatternKind::Empty);
+						}
+					}
+
+					ranges.emplace_back(first, last);
+				}
+
+				if (IsEnd())
+				{
+					bError = true;
+					return AddNode(PatternKind::Empty);
+				}
+
+				++m_nPos;
+
+				if (bNegate)
+				{
+					if (m_bCaseless)
+					{
+						// Fold before the complement, so [^a] doesn't accept 'A'.
+						uint32_t set = AddSet(ranges);
+
+						ranges = Sets[Nodes[set].nArg];
+						Sets.pop_back();
+						Nodes.pop_back();
+					}
+
+					ranges = Complement(ranges);
+
+					bool bCaseless = std::exchange(m_bCaseless, false);
+					uint32_t set = AddSet(ranges);
+
+					m_bCaseless = bCaseless;
+
+					return set;
+				}
+
+				return AddSet(ranges);
+			}
+		};
+
+		bool                     m_bValid;
+
+		std::vector<Instruction> m_Program;
+		uint32_t                 m_nGroups;        // including group 0
+
+		std::vector<uint32_t>    m_Bounds;         // first characters of the classes 1..N-1 (class 0 starts at 0)
+		uint16_t                 m_Latin[256];     // class of characters 0..255
+		uint32_t                 m_nClasses;
+		std::vector<uint8_t>     m_SetClasses;     // [set * m_nClasses + class] - class belongs to the set
+
+		std::vector<uint32_t>    m_Table;          // [state * m_nClasses + class] - next state, 0 - dead
+		std::vector<uint8_t>     m_Accepting;      // [state]
+		bool                     m_bDfa;
+
+		bool Compile(const std::basic_string<Char>& pattern, bool bCaseless)
+		{
+			PatternParser parser(pattern, bCaseless);
+
+			uint32_t root = parser.Parse();
+
+			if (parser.bError)
+			{
+				return false;
+			}
+
+			m_nGroups = parser.nGroups;
+
+			auto emit = [this](Op code, uint32_t nArg = 0, uint32_t nArg2 = 0)
+			{
+				m_Program.push_back(Instruction{ code, nArg, nArg2 });
+
+				return static_cast<uint32_t>(m_Program.size() - 1);
+			};
+
+			auto next = [this]() { return static_cast<uint32_t>(m_Program.size()); };
+
+			// Thompson construction, Split prefers nArg: this is the order a backtracking engine tries.
+			std::function<void(uint32_t)> build = [&](uint32_t index)
+			{
+				const PatternNode& node = parser.Nodes[index];
+
+				switch (node.Kind)
+				{
+				case PatternKind::Empty:
+					break;
+
+				case PatternKind::Set:
+					emit(Op::Set, node.nArg);
+					break;
+
+				case PatternKind::Concat:
+					for (uint32_t child : node.Children)
+					{
+						build(child);
+					}
+					break;
+
+				case PatternKind::Alternate:
+				{
+					std::vector<uint32_t> jumps;
+
+					for (size_t i = 0; i < node.Children.size(); ++i)
+					{
+						if (i + 1 < node.Children.size())
+						{
+							uint32_t split = emit(Op::Split);
+
+							m_Program[split].nArg = next();
+							build(node.Children[i]);
+							jumps.push_back(emit(Op::Jump));
+							m_Program[split].nArg2 = next();
+						}
+						else
+						{
+							build(node.Children[i]);
+						}
+					}
+
+					for (uint32_t jump : jumps)
+					{
+						m_Program[jump].nArg = next();
+					}
+
+					break;
+				}
+
+				case PatternKind::Star:
+				{
+					uint32_t split = emit(Op::Split);
+
+					build(node.Children[0]);
+					emit(Op::Jump, split);
+
+					m_Program[split].nArg = split + 1;
+					m_Program[split].nArg2 = next();
+
+					if (!node.bGreedy)
+					{
+						std::swap(m_Program[split].nArg, m_Program[split].nArg2);
+					}
+
+					break;
+				}
+
+				case PatternKind::Plus:
+				{
+					uint32_t start = next();
+
+					build(node.Children[0]);
+
+					uint32_t split = emit(Op::Split, start);
+
+					m_Program[split].nArg2 = next();
+
+					if (!node.bGreedy)
+					{
+						std::swap(m_Program[split].nArg, m_Program[split].nArg2);
+					}
+
+					break;
+				}
+
+				case PatternKind::Quest:
+				{
+					uint32_t split = emit(Op::Split);
+
+					build(node.Children[0]);
+
+					m_Program[split].nArg = split + 1;
+					m_Program[split].nArg2 = next();
+
+					if (!node.bGreedy)
+					{
+						std::swap(m_Program[split].nArg, m_Program[split].nArg2);
+					}
+
+					break;
+				}
+
+				case PatternKind::Group:
+					emit(Op::Save, node.nArg * 2);
+					build(node.Children[0]);
+					emit(Op::Save, node.nArg * 2 + 1);
+					break;
+				}
+			};
+
+			emit(Op::Save, 0);
+			build(root);
+			emit(Op::Save, 1);
+			emit(Op::Accept);
+
+			return BuildClasses(parser.Sets);
+		}
+
+		bool BuildClasses(const std::vector<Ranges>& sets)
+		{
+			// Every range boundary starts a new class.
+			for (auto& ranges : sets)
+			{
+				for (auto& r : ranges)
+				{
+					m_Bounds.push_back(r.first);
+
+					if (r.second < MAX_CHAR)
+					{
+						m_Bounds.push_back(r.second + 1);
+					}
+				}
+			}
+
+			std::sort(m_Bounds.begin(), m_Bounds.end());
+			m_Bounds.erase(std::unique(m_Bounds.begin(), m_Bounds.end()), m_Bounds.end());
+
+			if ((m_Bounds.size()) && (m_Bounds[0] == 0))
+			{
+				m_Bounds.erase(m_Bounds.begin());
+			}
+
+			m_nClasses = static_cast<uint32_t>(m_Bounds.size() + 1);
+
+			if (m_nClasses > 0xFFFF)
+			{
+				return false;
+			}
+
+			for (uint32_t c = 0; c < 256; ++c)
+			{
+				m_Latin[c] = static_cast<uint16_t>(std::upper_bound(m_Bounds.cbegin(), m_Bounds.cend(), c) - m_Bounds.cbegin());
+			}
+
+			m_SetClasses.assign(sets.size() * m_nClasses, 0);
+
+			for (size_t set = 0; set < sets.size(); ++set)
+			{
+				for (uint32_t k = 0; k < m_nClasses; ++k)
+				{
+					uint32_t c = (k) ? m_Bounds[k - 1] : 0;
+
+					for (auto& r : sets[set])
+					{
+						if ((c >= r.first) && (c <= r.second))
+						{
+							m_SetClasses[set * m_nClasses + k] = 1;
+							break;
+						}
+					}
+				}
+			}
+
+			return true;
+		}
+
+		void BuildTable()
+		{
+			// DFA state is the set of Set/Accept instructions reachable without consuming a character.
+			std::vector<uint32_t> marks(m_Program.size(), 0);
+			std::vector<uint32_t> stack;
+			uint32_t stamp = 0;
+
+			auto closure = [&](std::vector<uint32_t>& pcs)
+			{
+				++stamp;
+
+				stack.assign(pcs.cbegin(), pcs.cend());
+				pcs.clear();
+
+				while (stack.size())
+				{
+					uint32_t pc = stack.back();
+
+					stack.pop_back();
+
+					if (marks[pc] == stamp)
+					{
+						continue;
+					}
+
+					marks[pc] = stamp;
+
+					const Instruction& ins = m_Program[pc];
+
+					switch (ins.Code)
+					{
+					case Op::Split: stack.push_back(ins.nArg2); stack.push_back(ins.nArg); break;
+					case Op::Jump:  stack.push_back(ins.nArg); break;
+					case Op::Save:  stack.push_back(pc + 1); break;
+					default:        pcs.push_back(pc); break;
+					}
+				}
+
+				std::sort(pcs.begin(), pcs.end());
+			};
+
+			std::map<std::vector<uint32_t>, uint32_t> mapStates;
+			std::vector<std::vector<uint32_t>> vecStates;
+
+			// State 0 is dead: no instruction left.
+			vecStates.emplace_back();
+			mapStates[vecStates[0]] = 0;
+
+			std::vector<uint32_t> start{ 0 };
+
+			closure(start);
+			mapStates[start] = 1;
+			vecStates.push_back(start);
+
+			m_Table.assign(2 * m_nClasses, 0);
+
+			for (uint32_t state = 1; state < vecStates.size(); ++state)
+			{
+				for (uint32_t k = 0; k < m_nClasses; ++k)
+				{
+					std::vector<uint32_t> target;
+
+					for (uint32_t pc : vecStates[state])
+					{
+						const Instruction& ins = m_Program[pc];
+
+						if ((ins.Code == Op::Set) && (m_SetClasses[ins.nArg * m_nClasses + k]))
+						{
+							target.push_back(pc + 1);
+						}
+					}
+
+					closure(target);
+
+					auto it = mapStates.find(target);
+
+					if (it == mapStates.end())
+					{
+						if (vecStates.size() >= MAX_STATES)
+						{
+							// Too large, matching goes to the backtracking pass.
+							m_Table.clear();
+							m_Accepting.clear();
+							return;
+						}
+
+						it = mapStates.emplace(target, static_cast<uint32_t>(vecStates.size())).first;
+						vecStates.push_back(target);
+						m_Table.resize(vecStates.size() * m_nClasses, 0);
+					}
+
+					m_Table[state * m_nClasses + k] = it->second;
+				}
+			}
+
+			m_Accepting.assign(vecStates.size(), 0);
+
+			for (uint32_t state = 1; state < vecStates.size(); ++state)
+			{
+				for (uint32_t pc : vecStates[state])
+				{
+					if (m_Program[pc].Code == Op::Accept)
+					{
+						m_Accepting[state] = 1;
+					}
+				}
+			}
+
+			m_bDfa = true;
+		}
+
+		uint32_t GetClass(uint32_t c) const
+		{
+			if (c < 256)
+			{
+				return m_Latin[c];
+			}
+
+			return static_cast<uint32_t>(std::upper_bound(m_Bounds.cbegin(), m_Bounds.cend(), c) - m_Bounds.cbegin());
+		}
+
+		bool RunTable(View s) const
+		{
+			const uint32_t* pTable = m_Table.data();
+			uint32_t state = 1;
+
+			for (Char c : s)
+			{
+				if constexpr (MAX_CHAR < 256)
+				{
+					state = pTable[state * m_nClasses + m_Latin[Traits::Code(c)]];
+				}
+				else
+				{
+					state = pTable[state * m_nClasses + GetClass(Traits::Code(c))];
+				}
+
+				if (!state)
+				{
+					return false;
+				}
+			}
+
+			return (m_Accepting[state] != 0);
+		}
+
+		static void ResetGroups(View s, Groups& groups, size_t nGroups)
+		{
+			groups.resize(nGroups);
+
+			for (auto& g : groups)
+			{
+				g.first = s.data() + s.size();
+				g.second = s.data() + s.size();
+				g.matched = false;
+			}
+		}
+
+		// pGroups == nullptr - only whether the line matches.
+		bool RunBacktrack(View s, std::vector<size_t>& scratch, Groups* pGroups) const
+		{
+			// Scratch layout: visited bits for every (instruction, position) pair, the group slots,
+			// then the stack of alternatives.
+			const size_t nProgram = m_Program.size();
+			const size_t nSlots = m_nGroups * 2;
+			const size_t nBits = nProgram * (s.size() + 1);
+			const size_t nBitsPerWord = sizeof(size_t) * 8;
+			const size_t nWords = (nBits + nBitsPerWord - 1) / nBitsPerWord;
+			const size_t nBase = nWords + nSlots;
+
+			if (scratch.size() < nBase + 16)
+			{
+				scratch.resize(nBase + 16);
+			}
+
+			std::fill(scratch.begin(), scratch.begin() + nWords, 0);
+			std::fill(scratch.begin() + nWords, scratch.begin() + nBase, NO_POS);
+
+			// Stack entry: (pc, pos), or a slot to restore (slot | RESTORE) and its old value.
+			const size_t RESTORE = ~(static_cast<size_t>(-1) >> 1);
+
+			size_t nTop = nBase;
+
+			auto push = [&scratch, &nTop](size_t a, size_t b)
+			{
+				if (nTop + 2 > scratch.size())
+				{
+					scratch.resize(scratch.size() * 2);
+				}
+
+				scratch[nTop++] = a;
+				scratch[nTop++] = b;
+			};
+
+			push(0, 0);
+
+			bool bFound = false;
+
+			while ((nTop > nBase) && (!bFound))
+			{
+				size_t pos = scratch[--nTop];
+				size_t entry = scratch[--nTop];
+
+				if (entry & RESTORE)
+				{
+					scratch[nWords + (entry & ~RESTORE)] = pos;
+					continue;
+				}
+
+				uint32_t pc = static_cast<uint32_t>(entry);
+
+				// Follow the preferred path, alternatives go to the stack.
+				for (;;)
+				{
+					size_t bit = static_cast<size_t>(pc) * (s.size() + 1) + pos;
+					size_t& word = scratch[bit / nBitsPerWord];
+					size_t mask = static_cast<size_t>(1) << (bit % nBitsPerWord);
+
+					if (word & mask)
+					{
+						// Already tried from here, and it failed.
+						break;
+					}
+
+					word |= mask;
+
+					const Instruction& ins = m_Program[pc];
+
+					if (ins.Code == Op::Set)
+					{
+						if ((pos >= s.size()) || (!m_SetClasses[ins.nArg * m_nClasses + GetClass(Traits::Code(s[pos]))]))
+						{
+							break;
+						}
+
+						++pc;
+						++pos;
+					}
+					else if (ins.Code == Op::Split)
+					{
+						push(ins.nArg2, pos);
+						pc = ins.nArg;
+					}
+					else if (ins.Code == Op::Jump)
+					{
+						pc = ins.nArg;
+					}
+					else if (ins.Code == Op::Save)
+					{
+						push(ins.nArg | RESTORE, scratch[nWords + ins.nArg]);
+						scratch[nWords + ins.nArg] = pos;
+						++pc;
+					}
+					else
+					{
+						// Accept counts only at the end of the line.
+						bFound = (pos == s.size());
+						break;
+					}
+				}
+			}
+
+			if ((!bFound) || (!pGroups))
+			{
+				return bFound;
+			}
+
+			Groups& groups = *pGroups;
+
+			ResetGroups(s, groups, m_nGroups);
+
+			for (uint32_t g = 0; g < m_nGroups; ++g)
+			{
+				size_t nBegin = scratch[nWords + g * 2];
+				size_t nEnd = scratch[nWords + g * 2 + 1];
+
+				if ((nBegin != NO_POS) && (nEnd != NO_POS))
+				{
+					groups[g].first = s.data() + nBegin;
+					groups[g].second = s.data() + nEnd;
+					groups[g].matched = true;
+				}
+			}
+
+			return true;
+		}
+
+	public:
+		DfaEngine(const std::basic_string<Char>& pattern, bool bCaseless)
+			: m_bValid(false), m_nGroups(1), m_Latin{}, m_nClasses(1), m_bDfa(false)
+		{
+			m_bValid = Compile(pattern, bCaseless);
+
+			if (m_bValid)
+			{
+				BuildTable();
+			}
+		}
+
+		// FALSE if the pattern uses syntax outside of the subset; Match() and Test() always fail then.
+		bool IsValid() const { return m_bValid; }
+
+		// TRUE if the whole line matches, groups receive the groups; scratch is working memory kept
+		// by the caller between matches, so a match doesn't allocate (after the first lines).
+		bool Match(View s, std::vector<size_t>& scratch, Groups& groups) const
+		{
+			if (!m_bValid)
+			{
+				return false;
+			}
+
+			if (m_bDfa)
+			{
+				if (!RunTable(s))
+				{
+					return false;
+				}
+
+				if (m_nGroups == 1)
+				{
+					// No groups: the whole line is all there is.
+					ResetGroups(s, groups, 1);
+					groups[0].first = s.data();
+					groups[0].matched = true;
+
+					return true;
+				}
+			}
+
+			return RunBacktrack(s, scratch, &groups);
+		}
+
+		// Same answer as Match() without the groups: the table pass only.
+		bool Test(View s, std::vector<size_t>& scratch) const
+		{
+			if (!m_bValid)
+			{
+				return false;
+			}
+
+			return (m_bDfa) ? RunTable(s) : RunBacktrack(s, scratch, nullptr);
+		}
+	};
+}
@@ -0,0 +1,186 @@
+#include "auxKeyBenchmark.h"
+#include "auxKeyGenerator.h"
+#include "auxConcurrentKeyGenerator.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// auxKeyGenerator has no synchronization of its own, so it is shared behind a mutex.
+	class MutexKeyGenerator
+	{
+	private:
+		std::mutex      m_Mutex;
+		auxKeyGenerator m_Generator;
+
+	public:
+		MutexKeyGenerator(uint32_t nMaxKeys) : m_Generator(nMaxKeys)
+		{
+		}
+
+		void Allocate(uint32_t* pKeys, uint32_t nCount)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			for (uint32_t i = 0; i < nCount; ++i)
+			{
+				m_Generator >> pKeys[i];
+			}
+		}
+
+		void Free(const uint32_t* pKeys, uint32_t nCount)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			for (uint32_t i = 0; i < nCount; ++i)
+			{
+				m_Generator << pKeys[i];
+			}
+		}
+	};
+
+	// One round of the workload for a single thread: take nCount keys into pKeys and give them back.
+	using RoundFunction = std::function<void(uint32_t* pKeys, uint32_t nCount)>;
+
+	// Runs nThreads threads doing nOpsPerThread allocate+free operations each, returns elapsed seconds.
+	double RunThreads(uint32_t nThreads, uint32_t nOpsPerThread, uint32_t nHeldKeys, const RoundFunction& round)
+	{
+		std::atomic<uint32_t> nReady{ 0 };
+		std::atomic<bool>     bStart{ false };
+		std::vector<std::thread> vecThreads;
+
+		for (uint32_t t = 0; t < nThreads; ++t)
+		{
+			vecThreads.emplace_back([&]()
+			{
+				std::vector<uint32_t> vecKeys(nHeldKeys);
+
+				nReady++;
+
+				while (!bStart.load(std::memory_order_acquire))
+				{
+					std::this_thread::yield();
+				}
+
+				for (uint32_t n = 0; n < nOpsPerThread; n += nHeldKeys)
+				{
+					round(vecKeys.data(), nHeldKeys);
+				}
+			});
+		}
+
+		while (nReady.load() < nThreads)
+		{
+			std::this_thread::yield();
+		}
+
+		auto t0 = std::chrono::steady_clock::now();
+
+		bStart.store(true, std::memory_order_release);
+
+		for (auto& t : vecThreads)
+		{
+			t.join();
+		}
+
+		auto t1 = std::chrono::steady_clock::now();
+
+		return std::chrono::duration<double>(t1 - t0).count();
+	}
+}
+
+void auxKeyGeneratorBenchmark(std::ostream& os, uint32_t nMaxThreads, uint32_t nOpsPerThread, uint32_t nHeldKeys)
+{
+	if ((!nMaxThreads) || (!nHeldKeys))
+	{
+		return;
+	}
+
+	// Enough keys for every thread to hold its share plus the thread caches.
+	const uint32_t nMaxKeys{ nMaxThreads * (nHeldKeys + 64) + 1024 };
+
+	os << std::left << std::setw(18) << "generator" << std::right << std::setw(9) << "threads"
+		<< std::setw(12) << "Mops/s" << std::setw(12) << "ns/op" << std::endl;
+
+	auto report = [&os, nOpsPerThread](const char* pName, uint32_t nThreads, double seconds)
+	{
+		// Every key is allocated and freed: two operations.
+		double ops = 2.0 * nOpsPerThread * nThreads;
+
+		os << std::left << std::setw(18) << pName << std::right << std::setw(9) << nThreads
+			<< std::fixed << std::setprecision(2)
+			<< std::setw(12) << (ops / seconds / 1e6)
+			<< std::setw(12) << (seconds * 1e9 * nThreads / ops) << std::endl;
+	};
+
+	for (uint32_t nThreads = 1; nThreads <= nMaxThreads; nThreads *= 2)
+	{
+		{
+			MutexKeyGenerator gen(nMaxKeys);
+
+			report("mutex", nThreads, RunThreads(nThreads, nOpsPerThread, nHeldKeys, [&gen](uint32_t* pKeys, uint32_t nCount)
+			{
+				gen.Allocate(pKeys, nCount);
+				gen.Free(pKeys, nCount);
+			}));
+		}
+
+		{
+			auxConcurrentKeyGenerator gen(nMaxKeys, 0);
+
+			report("bitmap", nThreads, RunThreads(nThreads, nOpsPerThread, nHeldKeys, [&gen](uint32_t* pKeys, uint32_t nCount)
+			{
+				for (uint32_t i = 0; i < nCount; ++i)
+				{
+					gen.Allocate(pKeys[i]);
+				}
+
+				for (uint32_t i = 0; i < nCount; ++i)
+				{
+					gen.Free(pKeys[i]);
+				}
+			}));
+		}
+
+		{
+			auxConcurrentKeyGenerator gen(nMaxKeys, 32);
+
+			report("bitmap+cache", nThreads, RunThreads(nThreads, nOpsPerThread, nHeldKeys, [&gen](uint32_t* pKeys, uint32_t nCount)
+			{
+				for (uint32_t i = 0; i < nCount; ++i)
+				{
+					gen.Allocate(pKeys[i]);
+				}
+
+				for (uint32_t i = 0; i < nCount; ++i)
+				{
+					gen.Free(pKeys[i]);
+				}
+			}));
+		}
+
+		{
+			auxConcurrentKeyGenerator gen(nMaxKeys, 0);
+
+			report("bitmap batch", nThreads, RunThreads(nThreads, nOpsPerThread, nHeldKeys, [&gen](uint32_t* pKeys, uint32_t nCount)
+			{
+				uint32_t n = gen.AllocateBatch(pKeys, nCount);
+
+				gen.FreeBatch(pKeys, n);
+			}));
+		}
+
+		if ((nThreads < nMaxThreads) && (nThreads * 2 > nMaxThreads))
+		{
+			// Always finish with exactly nMaxThreads.
+			nThreads = nMaxThreads / 2;
+		}
+	}
+}
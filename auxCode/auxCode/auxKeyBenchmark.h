@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+
+// Multi-threaded contention benchmark for key generators.
+//
+// Every thread repeatedly takes nHeldKeys keys and gives them back. The same workload runs for
+// auxKeyGenerator behind a std::mutex (the way it has to be shared today) and for
+// auxConcurrentKeyGenerator with and without thread caches and in batch mode, at 1, 2, 4, ...
+// nMaxThreads threads. Throughput (million operations per second) and mean ns per operation
+// are printed for every combination.
+
+void auxKeyGeneratorBenchmark(std::ostream& os, uint32_t nMaxThreads = 32, uint32_t nOpsPerThread = 200000,
+	uint32_t nHeldKeys = 16);
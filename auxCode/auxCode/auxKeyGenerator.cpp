@@ -1,13 +1,69 @@
 #include "auxKeyGenerator.h"
 
-auxKeyGenerator::auxKeyGenerator(uint32_t nMaxKeys)
+auxKeyGenerator::auxKeyGenerator(uint32_t nMaxKeys, uint32_t nGenerationBits)
 {
 	m_nMaxKeys = nMaxKeys;
 	m_nKeysEmitted = 0;
+
+	// At least 2 generation bits are needed for a reused index to get a different generation,
+	// and at least 1 bit has to be left for the index.
+	if (nGenerationBits)
+	{
+		nGenerationBits = (nGenerationBits < 2) ? 2 : ((nGenerationBits > 31) ? 31 : nGenerationBits);
+	}
+
+	m_nIndexBits = 32 - nGenerationBits;
+
+	if (IsGenerational())
+	{
+		// Keys must fit into the index part.
+		uint32_t nMaxIndex = (1u << m_nIndexBits) - 1;
+
+		if (m_nMaxKeys > nMaxIndex)
+		{
+			m_nMaxKeys = nMaxIndex;
+		}
+
+		// Slot 0 is never used (0 is not a valid key index).
+		m_vecSlots.push_back(0);
+	}
 }
 
 auxKeyGenerator& auxKeyGenerator::operator >> (uint32_t& key)
 {
+	if (IsGenerational())
+	{
+		uint32_t index;
+
+		if (m_vecFreeList.size())
+		{
+			// Reuse the most recently freed index.
+			index = m_vecFreeList.back();
+			m_vecFreeList.pop_back();
+		}
+		else
+		{
+			if (m_nKeysEmitted >= m_nMaxKeys)
+			{
+				//throw XException(L"XKeyGenerator::operator >>(): No more keys. Max: '%d'.", m_nMaxKeys);
+				return *this;
+			}
+
+			index = ++m_nKeysEmitted;
+
+			// New slot starts at generation 0 (free).
+			m_vecSlots.push_back(index);
+		}
+
+		// Free slot holds an even generation, the next one (odd) is the issued key.
+		uint32_t nGeneration = ((m_vecSlots[index] >> m_nIndexBits) + 1) & ((1u << (32 - m_nIndexBits)) - 1);
+
+		key = (nGeneration << m_nIndexBits) | index;
+		m_vecSlots[index] = key;
+
+		return *this;
+	}
+
 	// Check: do we have anythig in our key pool?
 
 	if (m_setKeyPool.size())
@@ -39,6 +95,25 @@ auxKeyGenerator& auxKeyGenerator::operator >> (uint32_t& key)
 
 auxKeyGenerator& auxKeyGenerator::operator << (uint32_t key)
 {
+	if (IsGenerational())
+	{
+		// Stale keys (older generation) and double frees are ignored.
+		if (!IsValid(key))
+		{
+			//throw XException(L"XKeyGenerator::operator <<(): Invalid key '%d'.", key);
+			return *this;
+		}
+
+		uint32_t index = GetIndex(key);
+		uint32_t nGeneration = (GetGeneration(key) + 1) & ((1u << (32 - m_nIndexBits)) - 1);
+
+		// Even generation: the slot is free, old key no longer matches.
+		m_vecSlots[index] = (nGeneration << m_nIndexBits) | index;
+		m_vecFreeList.push_back(index);
+
+		return *this;
+	}
+
 	// Key must be lower than m_nKeysEmitted and be missing in the pool.
 
 	if ((key > m_nKeysEmitted) || (m_setKeyPool.find(key) != m_setKeyPool.end()))
@@ -50,3 +125,36 @@ auxKeyGenerator& auxKeyGenerator::operator << (uint32_t key)
 
 	return *this;
 }
+
+bool auxKeyGenerator::IsValid(uint32_t key) const
+{
+	if (IsGenerational())
+	{
+		uint32_t index = GetIndex(key);
+
+		// Issued keys always carry an odd generation.
+		return (index < m_vecSlots.size()) && (m_vecSlots[index] == key) && (GetGeneration(key) & 1);
+	}
+
+	return (key) && (key <= m_nKeysEmitted) && (m_setKeyPool.find(key) == m_setKeyPool.end());
+}
+
+uint32_t auxKeyGenerator::GetIndex(uint32_t key) const
+{
+	if (!IsGenerational())
+	{
+		return key;
+	}
+
+	return key & ((1u << m_nIndexBits) - 1);
+}
+
+uint32_t auxKeyGenerator::GetGeneration(uint32_t key) const
+{
+	if (!IsGenerational())
+	{
+		return 0;
+	}
+
+	return key >> m_nIndexBits;
+}
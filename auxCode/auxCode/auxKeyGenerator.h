@@ -1,6 +1,15 @@
 #pragma once
 
+#include <cstdint>
 #include <unordered_set>
+#include <vector>
+
+// Keys are 1..nMaxKeys.
+//
+// With nGenerationBits > 0 the generator works in generational mode: the low (32 - nGenerationBits)
+// bits of a key hold the index, the high bits hold a generation counter of that index. Every time
+// an index is reused its generation changes, so a stale key held after "<<" never becomes valid
+// again (until the counter wraps). IsValid() is a single array load.
 
 class auxKeyGenerator
 {
@@ -9,11 +18,28 @@ private:
 	uint32_t                     m_nMaxKeys;
 	std::unordered_set<uint32_t> m_setKeyPool;
 
+	// Generational mode.
+	uint32_t                     m_nIndexBits;   // 32 - nGenerationBits (32 = mode is off)
+	std::vector<uint32_t>        m_vecSlots;     // index -> current key (odd generation = issued, even = free)
+	std::vector<uint32_t>        m_vecFreeList;  // freed indexes, reused last-in first-out
+
 public:
-	auxKeyGenerator(uint32_t nMaxKeys);
+	auxKeyGenerator(uint32_t nMaxKeys, uint32_t nGenerationBits = 0);
 
 	auxKeyGenerator& operator >> (uint32_t& key) ;
 
 	auxKeyGenerator& operator << (uint32_t key);
+
+	// Generational mode: TRUE if the key is currently issued. Without the mode: TRUE if the key
+	// has been emitted and is not in the pool.
+	bool IsValid(uint32_t key) const;
+
+	// Index part of the key (the key itself when generational mode is off).
+	uint32_t GetIndex(uint32_t key) const;
+
+	// Generation part of the key (0 when generational mode is off).
+	uint32_t GetGeneration(uint32_t key) const;
+
+	bool IsGenerational() const { return (m_nIndexBits < 32); }
 };
 
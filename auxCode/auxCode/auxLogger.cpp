@@ -1,5 +1,644 @@
 #include "auxLogger.h"
 
-std::unique_ptr<aux::Logger> aux::Logger::m_Logger;
+#include <algorithm>
+#include <cstring>
+
 std::mutex aux::Logger::m_Mutex;
-std::ostream* aux::Logger::m_pLogStream = &std::cout;
\ No newline at end of file
+std::ostream* aux::Logger::m_pLogStream = &std::cout;
+std::atomic<int> aux::Logger::m_nLevel{ AUX_LOG_LEVEL };
+
+namespace aux
+{
+	// Batch of the background thread: text, or the frames of a binary log.
+	class LoggerBatch
+	{
+	private:
+		bool              m_bBinary;
+		std::string       m_Data;
+		std::vector<bool> m_Formats;  // formats already written to the binary log
+
+	public:
+		std::string       Record;     // record being read out of a ring
+
+		LoggerBatch(bool bBinary) : m_bBinary(bBinary)
+		{
+		}
+
+		void Clear() { m_Data.clear(); }
+
+		bool IsEmpty() const { return m_Data.empty(); }
+
+		const std::string& GetData() const { return m_Data; }
+
+		void AddText(std::string_view s)
+		{
+			if (m_bBinary)
+			{
+				AppendLoggerFrame(m_Data, LoggerFrame::Text, s);
+			}
+			else
+			{
+				m_Data += s;
+			}
+		}
+
+		void AddRecord(std::string_view record)
+		{
+			if (!m_bBinary)
+			{
+				FormatLoggerRecord(record, m_Data);
+
+				return;
+			}
+
+			uint32_t nId;
+
+			memcpy(&nId, record.data(), sizeof(nId));
+
+			if ((nId >= m_Formats.size()) || (!m_Formats[nId]))
+			{
+				const char* pFormat = LoggerFormat::Find(nId);
+				std::string format(reinterpret_cast<const char*>(&nId), sizeof(nId));
+
+				format += (pFormat) ? pFormat : "";
+
+				AppendLoggerFrame(m_Data, LoggerFrame::Format, format);
+
+				m_Formats.resize(std::max<size_t>(m_Formats.size(), nId + 1));
+				m_Formats[nId] = true;
+			}
+
+			AppendLoggerFrame(m_Data, LoggerFrame::Record, record);
+		}
+	};
+
+	// Records are a 32-bit length and the bytes, stored with wrap-around. RECORD in the length marks
+	// an encoded binary record, otherwise the bytes are text. Positions grow without
+	// bound, the index in pData is position & nMask. The producer and the consumer members are on
+	// separate cache lines.
+	struct LoggerRing
+	{
+		std::unique_ptr<char[]> pData;
+		size_t                  nCapacity;
+		size_t                  nMask;
+
+		// Producer:
+		alignas(64) std::atomic<size_t> nHead{ 0 };
+		size_t                          nTailCache{ 0 };  // last nTail seen, read again only when the ring looks full
+		std::atomic<uint64_t>           nDropped{ 0 };
+
+		// Consumer:
+		alignas(64) std::atomic<size_t> nTail{ 0 };       // records before nTail are collected
+		std::atomic<size_t>             nDone{ 0 };       // records before nDone are written to the stream
+		uint64_t                        nReported{ 0 };   // drops already logged (CountDrops)
+		std::atomic<bool>               bClosed{ false }; // the thread has exited
+
+		static constexpr uint32_t RECORD = 0x80000000;
+
+		LoggerRing(size_t nSize) : pData(new char[nSize]), nCapacity(nSize), nMask(nSize - 1)
+		{
+		}
+
+		void Write(size_t nPos, const void* p, size_t nSize)
+		{
+			size_t nIndex = nPos & nMask;
+			size_t nFirst = std::min(nSize, nCapacity - nIndex);
+
+			memcpy(&pData[nIndex], p, nFirst);
+			memcpy(&pData[0], static_cast<const char*>(p) + nFirst, nSize - nFirst);
+		}
+
+		void Read(size_t nPos, void* p, size_t nSize) const
+		{
+			size_t nIndex = nPos & nMask;
+			size_t nFirst = std::min(nSize, nCapacity - nIndex);
+
+			memcpy(p, &pData[nIndex], nFirst);
+			memcpy(static_cast<char*>(p) + nFirst, &pData[0], nSize - nFirst);
+		}
+
+		// Adds the records in [nPos, nEnd) to the batch.
+		void Collect(size_t nPos, size_t nEnd, LoggerBatch& batch) const
+		{
+			while (nPos < nEnd)
+			{
+				uint32_t nLength;
+
+				Read(nPos, &nLength, sizeof(nLength));
+				nPos += sizeof(nLength);
+
+				bool bRecord = (nLength & RECORD) != 0;
+
+				nLength &= ~RECORD;
+
+				batch.Record.resize(nLength);
+				Read(nPos, &batch.Record[0], nLength);
+				nPos += nLength;
+
+				if (bRecord)
+				{
+					batch.AddRecord(batch.Record);
+				}
+				else
+				{
+					batch.AddText(batch.Record);
+				}
+			}
+		}
+	};
+
+	namespace
+	{
+		// Ring of the thread; the destructor tells the background thread the ring can go
+		// once it is empty.
+		struct LoggerThreadRing
+		{
+			std::shared_ptr<LoggerRing> spRing;
+
+			~LoggerThreadRing()
+			{
+				if (spRing)
+				{
+					spRing->bClosed.store(true, std::memory_order_release);
+				}
+			}
+		};
+
+		thread_local LoggerThreadRing t_Ring;
+	}
+
+	LoggerRing& Logger::GetRing()
+	{
+		if (!t_Ring.spRing)
+		{
+			std::lock_guard<std::mutex> lock(m_RingMutex);
+
+			size_t nSize = 256;
+
+			while (nSize < m_nBufferSize.load(std::memory_order_relaxed))
+			{
+				nSize <<= 1;
+			}
+
+			t_Ring.spRing = std::make_shared<LoggerRing>(nSize);
+
+			m_Rings.push_back(t_Ring.spRing);
+		}
+
+		return *t_Ring.spRing;
+	}
+
+	void Logger::WakeWriter()
+	{
+		if (!m_bWake.exchange(true, std::memory_order_relaxed))
+		{
+			m_WriterWake.notify_one();
+		}
+	}
+
+	void Logger::WriteDirect(std::string_view s, bool bRecord)
+	{
+		std::string text;
+
+		if (bRecord)
+		{
+			FormatLoggerRecord(s, text);
+			s = text;
+		}
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		if ((m_bAsync.load(std::memory_order_relaxed)) && (m_bBinary.load(std::memory_order_relaxed)))
+		{
+			std::string frame;
+
+			AppendLoggerFrame(frame, LoggerFrame::Text, s);
+			m_pLogStream->write(frame.data(), frame.size());
+		}
+		else
+		{
+			m_pLogStream->write(s.data(), s.size());
+		}
+	}
+
+	void Logger::Push(std::string_view s, bool bRecord)
+	{
+		LoggerRing& ring = GetRing();
+		const size_t nSize = sizeof(uint32_t) + s.size();
+		const size_t nHead = ring.nHead.load(std::memory_order_relaxed);
+		const bool bBlock = (m_Overflow.load(std::memory_order_relaxed) == LoggerOverflow::Block);
+
+		if (nSize > ring.nCapacity)
+		{
+			// Too long for the ring: written here, once the earlier records of the thread are out.
+			while (ring.nDone.load(std::memory_order_acquire) != nHead)
+			{
+				if (m_bStopped.load(std::memory_order_acquire))
+				{
+					// Nobody collects the ring any more.
+					DrainRing(ring, nHead);
+
+					continue;
+				}
+
+				if (!bBlock)
+				{
+					ring.nDropped.store(ring.nDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+					return;
+				}
+
+				WakeWriter();
+				std::this_thread::yield();
+			}
+
+			WriteDirect(s, bRecord);
+
+			return;
+		}
+
+		while (ring.nCapacity - (nHead - ring.nTailCache) < nSize)
+		{
+			size_t nTail = ring.nTail.load(std::memory_order_acquire);
+
+			if (nTail != ring.nTailCache)
+			{
+				ring.nTailCache = nTail;
+
+				continue;
+			}
+
+			if (m_bStopped.load(std::memory_order_acquire))
+			{
+				if (DrainRing(ring, nHead))
+				{
+					WriteDirect(s, bRecord);
+
+					return;
+				}
+
+				continue;
+			}
+
+			if (!bBlock)
+			{
+				ring.nDropped.store(ring.nDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+				return;
+			}
+
+			WakeWriter();
+			std::this_thread::yield();
+		}
+
+		uint32_t nLength = static_cast<uint32_t>(s.size()) | ((bRecord) ? LoggerRing::RECORD : 0);
+
+		ring.Write(nHead, &nLength, sizeof(nLength));
+		ring.Write(nHead + sizeof(nLength), s.data(), s.size());
+
+		// Sequentially consistent with m_bStop: either StopAsync() collects the record or the thread
+		// sees the stop.
+		ring.nHead.store(nHead + nSize, std::memory_order_seq_cst);
+
+		if (m_bStop.load(std::memory_order_seq_cst))
+		{
+			DrainRing(ring, nHead + nSize);
+		}
+	}
+
+	bool Logger::DrainRing(LoggerRing& ring, size_t nEnd)
+	{
+		while ((m_bStop.load(std::memory_order_acquire)) && (!m_bStopped.load(std::memory_order_acquire)) &&
+			(ring.nTail.load(std::memory_order_acquire) < nEnd))
+		{
+			std::this_thread::yield();
+		}
+
+		LoggerBatch batch(false);
+
+		{
+			std::lock_guard<std::mutex> lock(m_RingMutex);
+
+			// Restarted meanwhile: the new background thread collects the ring.
+			if (!m_bStopped.load(std::memory_order_relaxed))
+			{
+				return false;
+			}
+
+			size_t nTail = ring.nTail.load(std::memory_order_relaxed);
+			size_t nHead = ring.nHead.load(std::memory_order_relaxed);
+
+			ring.Collect(nTail, nHead, batch);
+			ring.nTail.store(nHead, std::memory_order_release);
+			ring.nDone.store(nHead, std::memory_order_release);
+		}
+
+		if (batch.IsEmpty())
+		{
+			return true;
+		}
+
+		// Logging is synchronous now, the records are written as text.
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		m_pLogStream->write(batch.GetData().data(), batch.GetData().size());
+
+		return true;
+	}
+
+	bool Logger::WriteBatch(LoggerBatch& batch)
+	{
+		struct Collected
+		{
+			LoggerRing* pRing;
+			size_t      nEnd;
+		};
+
+		std::vector<Collected> collected;
+		uint64_t nNewDrops = 0;
+
+		batch.Clear();
+
+		{
+			std::lock_guard<std::mutex> lock(m_RingMutex);
+
+			collected.reserve(m_Rings.size());
+
+			for (size_t i = 0; i < m_Rings.size(); )
+			{
+				LoggerRing& ring = *m_Rings[i];
+
+				// Closed before the head is read: the head is final.
+				bool bClosed = ring.bClosed.load(std::memory_order_acquire);
+				size_t nTail = ring.nTail.load(std::memory_order_relaxed);
+				size_t nHead = ring.nHead.load(std::memory_order_acquire);
+
+				if (nHead != nTail)
+				{
+					ring.Collect(nTail, nHead, batch);
+					ring.nTail.store(nHead, std::memory_order_release);
+				}
+
+				uint64_t nDropped = ring.nDropped.load(std::memory_order_relaxed);
+
+				nNewDrops += nDropped - ring.nReported;
+				ring.nReported = nDropped;
+
+				if (bClosed)
+				{
+					// Nobody waits for the records of an exited thread.
+					ring.nDone.store(nHead, std::memory_order_release);
+
+					m_nDropped += nDropped;
+					m_Rings.erase(m_Rings.begin() + i);
+
+					continue;
+				}
+
+				if (nHead != nTail)
+				{
+					collected.push_back({ &ring, nHead });
+				}
+
+				++i;
+			}
+		}
+
+		if ((nNewDrops) && (m_AsyncSettings.Overflow == LoggerOverflow::CountDrops))
+		{
+			batch.AddText("aux::Logger: " + std::to_string(nNewDrops) + " records dropped\n");
+		}
+
+		if (batch.IsEmpty())
+		{
+			return false;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			m_pLogStream->write(batch.GetData().data(), batch.GetData().size());
+			m_pLogStream->flush();
+		}
+
+		// The rings stay registered while their thread is alive, so the pointers are valid.
+		for (auto& c : collected)
+		{
+			c.pRing->nDone.store(c.nEnd, std::memory_order_release);
+		}
+
+		return true;
+	}
+
+	void Logger::WriterThread()
+	{
+		LoggerBatch batch(m_AsyncSettings.bBinary);
+
+		for (;;)
+		{
+			uint64_t nRequest = m_nFlushRequest.load(std::memory_order_acquire);
+			bool bStop = m_bStop.load(std::memory_order_acquire);
+
+			m_bWake.store(false, std::memory_order_relaxed);
+
+			bool bWritten = WriteBatch(batch);
+
+			if (nRequest != m_nFlushDone)
+			{
+				// Everything logged before the request is collected by the pass above.
+				{
+					std::lock_guard<std::mutex> lock(m_RingMutex);
+
+					m_nFlushDone = nRequest;
+				}
+
+				m_Flushed.notify_all();
+			}
+
+			if (bWritten)
+			{
+				continue;
+			}
+
+			if (bStop)
+			{
+				break;
+			}
+
+			std::unique_lock<std::mutex> lock(m_RingMutex);
+
+			m_WriterWake.wait_for(lock, std::chrono::milliseconds(m_AsyncSettings.nFlushInterval), [this, nRequest]()
+			{
+				return (m_bStop.load(std::memory_order_relaxed)) || (m_bWake.load(std::memory_order_relaxed)) ||
+					(m_nFlushRequest.load(std::memory_order_relaxed) != nRequest);
+			});
+		}
+	}
+
+	void Logger::StartAsync(const LoggerAsyncSettings& settings)
+	{
+		if (m_bAsync.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+
+		m_AsyncSettings = settings;
+		m_Overflow.store(settings.Overflow, std::memory_order_relaxed);
+		m_bBinary.store(settings.bBinary, std::memory_order_relaxed);
+
+		// Threads push to their rings before the stop of a restart is cleared: they write the rings
+		// themselves until then, so a record written directly never passes one left in a ring.
+		m_bAsync.store(true, std::memory_order_seq_cst);
+
+		{
+			std::lock_guard<std::mutex> lock(m_RingMutex);
+
+			m_nBufferSize.store(settings.nBufferSize, std::memory_order_relaxed);
+			m_bStop.store(false, std::memory_order_seq_cst);
+			m_bStopped.store(false, std::memory_order_relaxed);
+		}
+
+		m_Writer = std::thread(&Logger::WriterThread, this);
+	}
+
+	void Logger::StopAsync()
+	{
+		if (!m_bAsync.load(std::memory_order_acquire))
+		{
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_RingMutex);
+
+			if (m_bStop.exchange(true, std::memory_order_seq_cst))
+			{
+				return;
+			}
+		}
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		m_WriterWake.notify_one();
+		m_Writer.join();
+
+		// Records pushed after the last pass of the background thread; the threads that push later
+		// see m_bStopped and write their rings themselves.
+		LoggerBatch batch(m_AsyncSettings.bBinary);
+
+		WriteBatch(batch);
+
+		{
+			std::lock_guard<std::mutex> lock(m_RingMutex);
+
+			m_nFlushDone = m_nFlushRequest.load(std::memory_order_acquire);
+			m_bStopped.store(true, std::memory_order_release);
+		}
+
+		// Synchronous from here: the rings of the threads are empty or written by their threads, so
+		// a record written directly does not pass the earlier ones.
+		m_bAsync.store(false, std::memory_order_release);
+
+		m_Flushed.notify_all();
+	}
+
+	void Logger::Flush()
+	{
+		if (!m_bAsync.load(std::memory_order_acquire))
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			m_pLogStream->flush();
+
+			return;
+		}
+
+		uint64_t nRequest = m_nFlushRequest.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+		std::unique_lock<std::mutex> lock(m_RingMutex);
+
+		m_WriterWake.notify_one();
+		m_Flushed.wait(lock, [this, nRequest]()
+		{
+			return (m_nFlushDone >= nRequest) || (m_bStopped.load(std::memory_order_relaxed));
+		});
+
+		if (m_nFlushDone < nRequest)
+		{
+			// Requested after the last pass of StopAsync(): the records are written by their threads.
+			lock.unlock();
+
+			std::lock_guard<std::mutex> lockStream(m_Mutex);
+
+			m_pLogStream->flush();
+		}
+	}
+
+	uint64_t Logger::GetDropped() const
+	{
+		std::lock_guard<std::mutex> lock(m_RingMutex);
+		uint64_t nDropped = m_nDropped;
+
+		for (auto& spRing : m_Rings)
+		{
+			nDropped += spRing->nDropped.load(std::memory_order_relaxed);
+		}
+
+		return nDropped;
+	}
+
+	LoggerSite::LoggerSite(uint32_t nRate, uint32_t nBurst)
+	{
+		m_nInterval = (nRate) ? 1000000000LL / nRate : 0;
+		m_nBurst = (nBurst > 1) ? m_nInterval * (nBurst - 1) : 0;
+	}
+
+	bool LoggerSite::Acquire()
+	{
+		int64_t nNow = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+		int64_t nFull = m_nFull.load(std::memory_order_relaxed);
+
+		for (;;)
+		{
+			// Bucket empty: it is full only after all of its tokens are refilled.
+			if ((nFull != INT64_MIN) && (nNow < nFull - m_nBurst))
+			{
+				return false;
+			}
+
+			int64_t nNext = std::max(nFull, nNow) + m_nInterval;
+
+			if (m_nFull.compare_exchange_weak(nFull, nNext, std::memory_order_relaxed))
+			{
+				return true;
+			}
+		}
+	}
+
+	uint32_t LoggerSite::Register(const char* pFormat)
+	{
+		uint32_t nId = LoggerFormat::Register(pFormat);
+		uint32_t nExpected = NO_ID;
+
+		// Another thread may register the same site at the same time: its ID wins.
+		if (!m_nId.compare_exchange_strong(nExpected, nId, std::memory_order_acq_rel))
+		{
+			return nExpected;
+		}
+
+		return nId;
+	}
+
+	void LoggerSite::ReportSuppressed()
+	{
+		static const LoggerFormat format("aux::Logger: {} records suppressed by the rate limit\n");
+
+		uint64_t nSuppressed = m_nSuppressed.exchange(0, std::memory_order_relaxed);
+
+		if (nSuppressed)
+		{
+			Logger::Get().Log(format, nSuppressed);
+		}
+	}
+}
@@ -1,73 +1,331 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <iostream>
-#include <ctime>
 #include <chrono>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include "auxLoggerClock.h"
+#include "auxLoggerFormat.h"
+
+// Lowest level compiled in (LogLevel), AUX_LOG() statements below it are compiled to nothing.
+// Set it in the preprocessor definitions of the project to override.
+#ifndef AUX_LOG_LEVEL
+#ifdef _DEBUG
+#define AUX_LOG_LEVEL 0
+#else
+#define AUX_LOG_LEVEL 2
+#endif
+#endif
 
 namespace aux
 {
+	enum class LogLevel : int
+	{
+		Trace = 0,
+		Debug = 1,
+		Info = 2,
+		Warning = 3,
+		Error = 4,
+		Off = 5
+	};
+
+	constexpr LogLevel LOG_COMPILE_LEVEL = static_cast<LogLevel>(AUX_LOG_LEVEL);
+
+	// What a producer does when its ring buffer is full:
+	enum class LoggerOverflow : int
+	{
+		Block = 0,      // waits for the background thread
+		Drop = 1,       // drops the record
+		CountDrops = 2  // drops the record, the background thread logs how many were dropped
+	};
+
+	struct LoggerAsyncSettings
+	{
+		uint32_t       nBufferSize{ 1 << 16 };  // bytes per thread, rounded up to a power of two
+		LoggerOverflow Overflow{ LoggerOverflow::Block };
+		uint32_t       nFlushInterval{ 1 };     // ms the background thread sleeps when there is nothing to write
+		bool           bBinary{ false };        // the stream gets the frames of a binary log (DecodeLog()) instead of text
+	};
+
+	// Ring buffer of a producer thread and the batch of the background thread, defined in auxLogger.cpp.
+	struct LoggerRing;
+	class LoggerBatch;
+
 	class Logger
 	{
 	private:
 
-		static std::unique_ptr<Logger> m_Logger;
 		static std::mutex              m_Mutex;
 		static std::ostream*           m_pLogStream;
+		static std::atomic<int>        m_nLevel;
+
+		// Asynchronous mode: every thread writes its records into its own ring buffer (one producer,
+		// one consumer, no locks), the background thread collects them into batches and writes a
+		// batch to the stream under m_Mutex. Records of one thread keep their order, records of
+		// different threads are ordered by the time they are collected.
+		std::atomic<bool>                        m_bAsync{ false };
+		LoggerAsyncSettings                      m_AsyncSettings;  // read by the background thread and StopAsync()
+
+		// Settings read by the logging threads: a thread of the previous start may still be logging
+		// while StartAsync() sets them.
+		std::atomic<LoggerOverflow>              m_Overflow{ LoggerOverflow::Block };
+		std::atomic<uint32_t>                    m_nBufferSize{ 1 << 16 };  // read under m_RingMutex
+		std::atomic<bool>                        m_bBinary{ false };
+		std::thread                              m_Writer;
+		std::atomic<bool>                        m_bStop{ false };
+		std::atomic<bool>                        m_bStopped{ false };  // the last pass of StopAsync() is over
+
+		mutable std::mutex                       m_RingMutex;    // m_Rings and the writer wake-up
+		std::condition_variable                  m_WriterWake;
+		std::condition_variable                  m_Flushed;
+		std::vector<std::shared_ptr<LoggerRing>> m_Rings;
+		std::atomic<bool>                        m_bWake{ false };  // a producer waits for space
+		std::atomic<uint64_t>                    m_nFlushRequest{ 0 };
+		uint64_t                                 m_nFlushDone{ 0 };
+		std::atomic<uint64_t>                    m_nDropped{ 0 };
+
+		LoggerRing& GetRing();
+
+		void WakeWriter();
+
+		// bRecord - s is an encoded binary record, otherwise text.
+		void Push(std::string_view s, bool bRecord);
+
+		// Writes s to the stream from the logging thread.
+		void WriteDirect(std::string_view s, bool bRecord);
+
+		// StopAsync() is running: waits until the ring is collected up to nEnd or the last pass is
+		// over, the thread writes the rest of its ring itself then. FALSE if asynchronous logging was
+		// started again meanwhile (the new background thread collects the ring).
+		bool DrainRing(LoggerRing& ring, size_t nEnd);
+
+		void WriterThread();
+
+		// Moves the records of all rings to the stream, FALSE if there was nothing to write.
+		bool WriteBatch(LoggerBatch& batch);
 
 	private:
 		Logger()
 		{
 			// private ctor
 		}
-    
+
 	public:
 		~Logger()
 		{
-			// public dtor
+			StopAsync();
 		}
 
 	public:
+		// Created on the first call; the initialization is thread-safe, later calls only test the guard.
 		static Logger& Get()
 		{
-			if (m_Logger == nullptr)
-			{
-				m_Logger = std::unique_ptr<Logger>(new Logger());
-			};
+			static Logger logger;
+
+			return logger;
+		}
 
-			return *(m_Logger);
+		// Runtime level: AUX_LOG() statements below it are skipped after one relaxed load.
+		static void SetLevel(LogLevel level)
+		{
+			m_nLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+		}
+
+		static LogLevel GetLevel()
+		{
+			return static_cast<LogLevel>(m_nLevel.load(std::memory_order_relaxed));
+		}
+
+		static bool IsEnabled(LogLevel level)
+		{
+			return static_cast<int>(level) >= m_nLevel.load(std::memory_order_relaxed);
 		}
 
 		Logger& operator << (const std::string& s)
 		{
+			if (m_bAsync.load(std::memory_order_acquire))
+			{
+				Push(s, false);
+
+				return *this;
+			}
+
 			{
 				std::lock_guard<std::mutex> lock(m_Mutex);
-				
+
 				(*m_pLogStream) << s;
 			}
 
 			return *this;
 		}
 
-		std::string Now()
+		// Binary record (see auxLoggerFormat.h): only the format ID and the arguments are copied here,
+		// the text is made by the background thread. Synchronous logging makes the text at once.
+		template <typename... Args>
+		void Log(const LoggerFormat& format, const Args&... args)
 		{
-			char timeBuf[0x100];
+			LogId(format.GetId(), args...);
+		}
+
+		// Same with the ID of LoggerFormat::Register().
+		template <typename... Args>
+		void LogId(uint32_t nId, const Args&... args)
+		{
+			LoggerRecordBuffer buffer;
 
-			std::time_t t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-		    ctime_s(timeBuf, sizeof(timeBuf), &t);
+			buffer.Append(&nId, sizeof(nId));
+			(PutLoggerArgument(buffer, args), ...);
+
+			if (m_bAsync.load(std::memory_order_acquire))
+			{
+				Push(buffer.GetView(), true);
+			}
+			else
+			{
+				WriteDirect(buffer.GetView(), true);
+			}
+		}
 
-			std::string ts = timeBuf;
-			ts.resize(ts.size() - 1);
-			
-			return ts;
+		// Local time "YYYY-MM-DD hh:mm:ss.mmm", refreshed every millisecond by LoggerClock.
+		std::string Now()
+		{
+			return LoggerClock::Get().Now();
 		}
 
 		void SetLogStream(std::ostream& stream)
 		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
 			m_pLogStream = &stream;
 		}
+
+		std::ostream& GetLogStream()
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			return *m_pLogStream;
+		}
+
+		// Starts the background thread, operator << only copies the record into the ring buffer of
+		// the calling thread after that. Records longer than the ring buffer are written directly
+		// (after the earlier records of the thread).
+		void StartAsync(const LoggerAsyncSettings& settings = LoggerAsyncSettings());
+
+		// Writes the remaining records and stops the background thread; logging is synchronous again.
+		// A thread logging at the same time writes the records left in its ring itself once the last
+		// pass is over, Flush() and a blocked producer return then.
+		void StopAsync();
+
+		bool IsAsync() const { return m_bAsync.load(std::memory_order_relaxed); }
+
+		// Waits until every record logged before the call is written and the stream flushed.
+		void Flush();
+
+		// Records dropped by the overflow policy since the start.
+		uint64_t GetDropped() const;
+	};
+
+	// Call site of AUX_LOG(): the ID of its format and its rate limit. The limit is a token bucket
+	// of nBurst records refilled with nRate records per second, kept as the time the bucket is full
+	// again (one compare-and-swap per record). Records over the limit are counted, the next record
+	// of the site that passes is preceded by their number.
+	class LoggerSite
+	{
+	private:
+		static constexpr uint32_t NO_ID = 0xffffffff;
+
+		std::atomic<uint32_t> m_nId{ NO_ID };
+		int64_t               m_nInterval;         // ns per token, 0 - no limit
+		int64_t               m_nBurst;            // ns of tokens above one
+		std::atomic<int64_t>  m_nFull{ INT64_MIN };  // steady_clock ns
+		std::atomic<uint64_t> m_nSuppressed{ 0 };
+
+		bool Acquire();
+
+		uint32_t Register(const char* pFormat);
+
+		void ReportSuppressed();
+
+	public:
+		// nRate == 0 - no limit.
+		LoggerSite(uint32_t nRate = 0, uint32_t nBurst = 1);
+
+		LoggerSite(const LoggerSite&) = delete;
+
+		LoggerSite& operator = (const LoggerSite&) = delete;
+
+		// FALSE if the record is over the limit (it is counted then); called before the arguments
+		// are evaluated.
+		bool Pass()
+		{
+			if ((!m_nInterval) || (Acquire()))
+			{
+				return true;
+			}
+
+			m_nSuppressed.fetch_add(1, std::memory_order_relaxed);
+
+			return false;
+		}
+
+		// pFormat is the same string literal on every call.
+		template <typename... Args>
+		void Log(const char* pFormat, const Args&... args)
+		{
+			if (m_nSuppressed.load(std::memory_order_relaxed))
+			{
+				ReportSuppressed();
+			}
+
+			uint32_t nId = m_nId.load(std::memory_order_acquire);
+
+			Logger::Get().LogId((nId != NO_ID) ? nId : Register(pFormat), args...);
+		}
+
+		// Records over the limit, not reported yet.
+		uint64_t GetSuppressed() const { return m_nSuppressed.load(std::memory_order_relaxed); }
 	};
 };
 
+// Binary record (Logger::Log()) at a level, the format is a string literal:
+//
+//	AUX_LOG(Info, "{}: loaded {} objects\n", aux::LoggerTime::Now(), nObjects);
+//
+// Below AUX_LOG_LEVEL the statement is compiled to nothing, below the runtime level
+// (Logger::SetLevel()) it costs one relaxed load; the arguments are not evaluated in both cases.
+#define AUX_LOG(level, ...) \
+	do \
+	{ \
+		if constexpr (aux::LogLevel::level >= aux::LOG_COMPILE_LEVEL) \
+		{ \
+			if (aux::Logger::IsEnabled(aux::LogLevel::level)) \
+			{ \
+				static aux::LoggerSite auxLoggerSite; \
+				auxLoggerSite.Log(__VA_ARGS__); \
+			} \
+		} \
+	} while (0)
+
+// Same, at most nRate records per second (bursts of nBurst) from this statement; the arguments
+// of the records over the limit are not evaluated.
+#define AUX_LOG_LIMITED(level, nRate, nBurst, ...) \
+	do \
+	{ \
+		if constexpr (aux::LogLevel::level >= aux::LOG_COMPILE_LEVEL) \
+		{ \
+			if (aux::Logger::IsEnabled(aux::LogLevel::level)) \
+			{ \
+				static aux::LoggerSite auxLoggerSite(nRate, nBurst); \
+				if (auxLoggerSite.Pass()) \
+				{ \
+					auxLoggerSite.Log(__VA_ARGS__); \
+				} \
+			} \
+		} \
+	} while (0)
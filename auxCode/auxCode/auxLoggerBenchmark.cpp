@@ -0,0 +1,356 @@
+#include "auxLoggerBenchmark.h"
+#include "auxLogger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// Stream buffer that discards everything.
+	class NullBuffer : public std::streambuf
+	{
+	protected:
+		int_type overflow(int_type c) override
+		{
+			return traits_type::not_eof(c);
+		}
+
+		std::streamsize xsputn(const char*, std::streamsize n) override
+		{
+			return n;
+		}
+	};
+
+	struct RunResult
+	{
+		double   fMeanNs;
+		double   fP99Ns;
+		uint64_t nDropped;
+	};
+
+	// Every 64th record is timed on its own for the percentile.
+	constexpr uint32_t SAMPLE_STEP = 64;
+
+	// Thread t logs its record n with log(logger, record, t, n); record is a preformatted line.
+	template <typename LogFunction>
+	RunResult RunThreads(uint32_t nThreads, uint32_t nRecordsPerThread, LogFunction log)
+	{
+		aux::Logger& logger = aux::Logger::Get();
+		std::atomic<uint32_t> nReady{ 0 };
+		std::atomic<bool>     bStart{ false };
+		std::vector<std::thread> vecThreads;
+		std::vector<double> vecSeconds(nThreads);
+		std::vector<std::vector<uint32_t>> vecSamples(nThreads);
+		uint64_t nDropped = logger.GetDropped();
+
+		for (uint32_t t = 0; t < nThreads; ++t)
+		{
+			vecThreads.emplace_back([&, t]()
+			{
+				std::string record = "thread " + std::to_string(t) + ": ";
+
+				record.resize(80, '.');
+				record += '\n';
+
+				std::vector<uint32_t>& samples = vecSamples[t];
+
+				samples.reserve(nRecordsPerThread / SAMPLE_STEP + 1);
+
+				// The first record creates the ring buffer of the thread.
+				log(logger, record, t, 0);
+
+				nReady++;
+
+				while (!bStart.load(std::memory_order_acquire))
+				{
+					std::this_thread::yield();
+				}
+
+				auto t0 = std::chrono::steady_clock::now();
+
+				for (uint32_t n = 0; n < nRecordsPerThread; ++n)
+				{
+					if (n % SAMPLE_STEP)
+					{
+						log(logger, record, t, n);
+
+						continue;
+					}
+
+					auto s0 = std::chrono::steady_clock::now();
+
+					log(logger, record, t, n);
+
+					auto s1 = std::chrono::steady_clock::now();
+
+					samples.push_back(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(s1 - s0).count()));
+				}
+
+				vecSeconds[t] = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+			});
+		}
+
+		while (nReady.load() < nThreads)
+		{
+			std::this_thread::yield();
+		}
+
+		bStart.store(true, std::memory_order_release);
+
+		for (auto& t : vecThreads)
+		{
+			t.join();
+		}
+
+		logger.Flush();
+
+		std::vector<uint32_t> samples;
+		double seconds = 0;
+
+		for (uint32_t t = 0; t < nThreads; ++t)
+		{
+			seconds += vecSeconds[t];
+			samples.insert(samples.end(), vecSamples[t].begin(), vecSamples[t].end());
+		}
+
+		size_t nP99 = samples.size() * 99 / 100;
+
+		std::nth_element(samples.begin(), samples.begin() + nP99, samples.end());
+
+		return { seconds * 1e9 / (double(nThreads) * nRecordsPerThread), double(samples[nP99]),
+			logger.GetDropped() - nDropped };
+	}
+}
+
+namespace aux
+{
+	void LoggerBenchmark(std::ostream& os, uint32_t nMaxThreads, uint32_t nRecordsPerThread)
+	{
+		if ((!nMaxThreads) || (!nRecordsPerThread))
+		{
+			return;
+		}
+
+		Logger& logger = Logger::Get();
+		std::ostream& stream = logger.GetLogStream();
+		NullBuffer buffer;
+		std::ostream null(&buffer);
+
+		logger.StopAsync();
+		logger.SetLogStream(null);
+
+		os << std::left << std::setw(16) << "mode" << std::right << std::setw(9) << "threads"
+			<< std::setw(12) << "ns/record" << std::setw(12) << "p99 ns" << std::setw(12) << "dropped" << std::endl;
+
+		enum class Record
+		{
+			Preformatted,  // the same line every time
+			Text,          // time and values formatted by the logging thread
+			Binary         // the same values as a binary record
+		};
+
+		struct
+		{
+			const char*    pName;
+			bool           bAsync;
+			LoggerOverflow Overflow;
+			Record         Kind;
+		}
+		modes[] = { { "sync", false, LoggerOverflow::Block, Record::Preformatted },
+			{ "async/block", true, LoggerOverflow::Block, Record::Preformatted },
+			{ "async/drop", true, LoggerOverflow::Drop, Record::Preformatted },
+			{ "async/count", true, LoggerOverflow::CountDrops, Record::Preformatted },
+			{ "async/text", true, LoggerOverflow::Drop, Record::Text },
+			{ "async/binary", true, LoggerOverflow::Drop, Record::Binary } };
+
+		static const LoggerFormat format("{}: thread {} record {} value {}\n");
+
+		for (uint32_t nThreads = 1; nThreads <= nMaxThreads; nThreads *= 2)
+		{
+			for (auto& m : modes)
+			{
+				if (m.bAsync)
+				{
+					LoggerAsyncSettings settings;
+
+					settings.Overflow = m.Overflow;
+					logger.StartAsync(settings);
+				}
+
+				RunResult r;
+
+				switch (m.Kind)
+				{
+				case Record::Preformatted:
+					r = RunThreads(nThreads, nRecordsPerThread, [](Logger& logger, const std::string& record, uint32_t, uint32_t)
+					{
+						logger << record;
+					});
+					break;
+
+				case Record::Text:
+					r = RunThreads(nThreads, nRecordsPerThread, [](Logger& logger, const std::string&, uint32_t t, uint32_t n)
+					{
+						char value[32];
+
+						snprintf(value, sizeof(value), "%g", n * 0.25);
+
+						logger << std::to_string(LoggerTime::Now().nMicroseconds) + ": thread " + std::to_string(t) +
+							" record " + std::to_string(n) + " value " + value + "\n";
+					});
+					break;
+
+				case Record::Binary:
+					r = RunThreads(nThreads, nRecordsPerThread, [](Logger& logger, const std::string&, uint32_t t, uint32_t n)
+					{
+						logger.Log(format, LoggerTime::Now(), t, n, n * 0.25);
+					});
+					break;
+				}
+
+				logger.StopAsync();
+
+				os << std::left << std::setw(16) << m.pName << std::right << std::setw(9) << nThreads
+					<< std::fixed << std::setprecision(1)
+					<< std::setw(12) << r.fMeanNs << std::setprecision(0) << std::setw(12) << r.fP99Ns
+					<< std::setw(12) << r.nDropped << std::endl;
+			}
+
+			if ((nThreads < nMaxThreads) && (nThreads * 2 > nMaxThreads))
+			{
+				// Always finish with exactly nMaxThreads.
+				nThreads = nMaxThreads / 2;
+			}
+		}
+
+		logger.SetLogStream(stream);
+
+		LoggerLevelBenchmark(os, nMaxThreads, nRecordsPerThread);
+		LoggerClockBenchmark(os);
+	}
+
+	void LoggerLevelBenchmark(std::ostream& os, uint32_t nMaxThreads, uint32_t nRecordsPerThread)
+	{
+		if ((!nMaxThreads) || (!nRecordsPerThread))
+		{
+			return;
+		}
+
+		Logger& logger = Logger::Get();
+		std::ostream& stream = logger.GetLogStream();
+		LogLevel level = Logger::GetLevel();
+		NullBuffer buffer;
+		std::ostream null(&buffer);
+		LoggerAsyncSettings settings;
+
+		settings.Overflow = LoggerOverflow::Drop;
+
+		logger.StopAsync();
+		logger.SetLogStream(null);
+		logger.StartAsync(settings);
+
+		// Warning and above are logged.
+		Logger::SetLevel(LogLevel::Warning);
+
+		os << std::left << std::setw(16) << "statement" << std::right << std::setw(9) << "threads"
+			<< std::setw(12) << "ns/record" << std::setw(12) << "p99 ns" << std::setw(12) << "dropped" << std::endl;
+
+		auto report = [&os](const char* pName, uint32_t nThreads, const RunResult& r)
+		{
+			os << std::left << std::setw(16) << pName << std::right << std::setw(9) << nThreads
+				<< std::fixed << std::setprecision(1)
+				<< std::setw(12) << r.fMeanNs << std::setprecision(0) << std::setw(12) << r.fP99Ns
+				<< std::setw(12) << r.nDropped << std::endl;
+		};
+
+		for (uint32_t nThreads : { 1u, nMaxThreads })
+		{
+			report("disabled", nThreads, RunThreads(nThreads, nRecordsPerThread, [](Logger&, const std::string&, uint32_t t, uint32_t n)
+			{
+				AUX_LOG(Info, "{}: thread {} record {}\n", LoggerTime::Now(), t, n);
+			}));
+
+			report("limited", nThreads, RunThreads(nThreads, nRecordsPerThread, [](Logger&, const std::string&, uint32_t t, uint32_t n)
+			{
+				AUX_LOG_LIMITED(Error, 1000, 100, "{}: thread {} record {}\n", LoggerTime::Now(), t, n);
+			}));
+
+			report("enabled", nThreads, RunThreads(nThreads, nRecordsPerThread, [](Logger&, const std::string&, uint32_t t, uint32_t n)
+			{
+				AUX_LOG(Warning, "{}: thread {} record {}\n", LoggerTime::Now(), t, n);
+			}));
+
+			if (nThreads == nMaxThreads)
+			{
+				break;
+			}
+		}
+
+		logger.StopAsync();
+		logger.SetLogStream(stream);
+		Logger::SetLevel(level);
+	}
+
+	void LoggerClockBenchmark(std::ostream& os, uint32_t nCalls)
+	{
+		LoggerClock& clock = LoggerClock::Get();
+		char buf[LoggerClock::TEXT_SIZE];
+		size_t nTotal = 0;
+
+		os << std::left << std::setw(16) << "timestamp" << std::right << std::setw(12) << "ns/call" << std::endl;
+
+		auto report = [&os, nCalls](const char* pName, std::chrono::steady_clock::time_point t0)
+		{
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+			os << std::left << std::setw(16) << pName << std::right << std::fixed << std::setprecision(1)
+				<< std::setw(12) << (seconds * 1e9 / nCalls) << std::endl;
+		};
+
+		auto t0 = std::chrono::steady_clock::now();
+
+		for (uint32_t n = 0; n < nCalls; ++n)
+		{
+			nTotal += LoggerClock::Format(std::chrono::system_clock::now(), buf);
+		}
+
+		report("format", t0);
+
+		t0 = std::chrono::steady_clock::now();
+
+		for (uint32_t n = 0; n < nCalls; ++n)
+		{
+			nTotal += clock.Read(buf);
+		}
+
+		report("cached", t0);
+
+		t0 = std::chrono::steady_clock::now();
+
+		for (uint32_t n = 0; n < nCalls; ++n)
+		{
+			nTotal += Logger::Get().Now().size();
+		}
+
+		report("Logger::Now()", t0);
+
+		t0 = std::chrono::steady_clock::now();
+
+		for (uint32_t n = 0; n < nCalls; ++n)
+		{
+			nTotal += static_cast<size_t>(LoggerClock::Ticks() & 1);
+		}
+
+		report("ticks", t0);
+
+		// Keeps the loops from being optimized out.
+		os << "characters: " << nTotal << ", ticks/s: " << std::setprecision(0) << LoggerClock::GetTicksPerSecond() << std::endl;
+	}
+}
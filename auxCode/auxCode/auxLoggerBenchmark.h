@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+
+// Producer latency of aux::Logger under contention.
+//
+// Every thread logs nRecordsPerThread records of about 80 characters to a stream that discards
+// them (so the numbers are the cost of the logger, not of the disk), at 1, 2, 4, ... nMaxThreads
+// threads, synchronously (global mutex) and asynchronously with every overflow policy. The last
+// runs log the time and a few values, formatted by the logging thread (text) or by the background
+// thread (Logger::Log()), with the Drop policy so that the background thread doesn't slow them down.
+// Mean and 99th percentile ns per record (of the logging thread) and the number of dropped records
+// are printed. The log stream of the logger is restored afterwards.
+//
+// Levels: AUX_LOG() below the runtime level, AUX_LOG_LIMITED() over its rate limit and AUX_LOG()
+// that is logged, at 1 and nMaxThreads threads.
+//
+// Timestamps: ns per call of formatting the time on every call, of the cached LoggerClock text
+// (raw and as Logger::Now()) and of LoggerClock::Ticks(). LoggerBenchmark() runs both at the end.
+
+namespace aux
+{
+	void LoggerBenchmark(std::ostream& os, uint32_t nMaxThreads = 32, uint32_t nRecordsPerThread = 100000);
+
+	void LoggerLevelBenchmark(std::ostream& os, uint32_t nMaxThreads = 32, uint32_t nRecordsPerThread = 100000);
+
+	void LoggerClockBenchmark(std::ostream& os, uint32_t nCalls = 1000000);
+}
@@ -0,0 +1,207 @@
+#include "auxLoggerClock.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define AUX_LOGGER_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define AUX_LOGGER_TSC
+#endif
+
+namespace
+{
+	// Date and time of day of t, "YYYY-MM-DD hh:mm:ss"; returns the length.
+	size_t FormatSecond(std::time_t t, char* pBuf, size_t nSize)
+	{
+		std::tm tm{};
+
+#ifdef _WIN32
+		localtime_s(&tm, &t);
+#else
+		localtime_r(&t, &tm);
+#endif
+
+		int n = snprintf(pBuf, nSize, "%04d-%02d-%02d %02d:%02d:%02d", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+			tm.tm_hour, tm.tm_min, tm.tm_sec);
+
+		return (n > 0) ? static_cast<size_t>(n) : 0;
+	}
+
+	void AppendMilliseconds(char* p, uint32_t nMilliseconds)
+	{
+		p[0] = '.';
+		p[1] = static_cast<char>('0' + nMilliseconds / 100);
+		p[2] = static_cast<char>('0' + nMilliseconds / 10 % 10);
+		p[3] = static_cast<char>('0' + nMilliseconds % 10);
+		p[4] = 0;
+	}
+}
+
+namespace aux
+{
+	LoggerClock::LoggerClock(uint32_t nInterval) : m_nInterval(nInterval)
+	{
+		for (auto& w : m_Text)
+		{
+			w.store(0, std::memory_order_relaxed);
+		}
+
+		Update(std::chrono::system_clock::now());
+
+		m_Ticker = std::thread(&LoggerClock::TickerThread, this);
+	}
+
+	LoggerClock::~LoggerClock()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			m_bStop = true;
+		}
+
+		m_Wake.notify_one();
+		m_Ticker.join();
+	}
+
+	LoggerClock& LoggerClock::Get()
+	{
+		static LoggerClock clock(1);
+
+		return clock;
+	}
+
+	void LoggerClock::Update(std::chrono::system_clock::time_point t)
+	{
+		int64_t nMilliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
+		int64_t nSecond = nMilliseconds / 1000;
+
+		if (nSecond != m_nSecond)
+		{
+			m_nSecond = nSecond;
+			m_nPrefix = FormatSecond(static_cast<std::time_t>(nSecond), m_Prefix, sizeof(m_Prefix) - 4);
+		}
+
+		uint64_t text[TEXT_SIZE / sizeof(uint64_t)] = {};
+
+		memcpy(text, m_Prefix, m_nPrefix);
+		AppendMilliseconds(reinterpret_cast<char*>(text) + m_nPrefix, static_cast<uint32_t>(nMilliseconds % 1000));
+
+		uint32_t nSequence = m_nSequence.load(std::memory_order_relaxed);
+
+		m_nSequence.store(nSequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		for (size_t i = 0; i < TEXT_SIZE / sizeof(uint64_t); ++i)
+		{
+			m_Text[i].store(text[i], std::memory_order_relaxed);
+		}
+
+		m_nSequence.store(nSequence + 2, std::memory_order_release);
+	}
+
+	void LoggerClock::TickerThread()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		auto next = std::chrono::steady_clock::now();
+
+		while (!m_bStop)
+		{
+			next += std::chrono::milliseconds(m_nInterval);
+
+			if (m_Wake.wait_until(lock, next, [this]() { return m_bStop; }))
+			{
+				break;
+			}
+
+			Update(std::chrono::system_clock::now());
+
+			// After a long sleep of the process the ticks are not caught up.
+			next = std::max(next, std::chrono::steady_clock::now() - std::chrono::milliseconds(m_nInterval));
+		}
+	}
+
+	size_t LoggerClock::Read(char* pBuf) const
+	{
+		uint64_t text[TEXT_SIZE / sizeof(uint64_t)];
+
+		for (;;)
+		{
+			uint32_t nSequence = m_nSequence.load(std::memory_order_acquire);
+
+			if (nSequence & 1)
+			{
+				continue;
+			}
+
+			for (size_t i = 0; i < TEXT_SIZE / sizeof(uint64_t); ++i)
+			{
+				text[i] = m_Text[i].load(std::memory_order_relaxed);
+			}
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if (m_nSequence.load(std::memory_order_relaxed) == nSequence)
+			{
+				break;
+			}
+		}
+
+		memcpy(pBuf, text, TEXT_SIZE);
+
+		return strlen(pBuf);
+	}
+
+	std::string LoggerClock::Now() const
+	{
+		char buf[TEXT_SIZE];
+		size_t nLength = Read(buf);
+
+		return std::string(buf, nLength);
+	}
+
+	size_t LoggerClock::Format(std::chrono::system_clock::time_point t, char* pBuf)
+	{
+		int64_t nMilliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
+		size_t nLength = FormatSecond(static_cast<std::time_t>(nMilliseconds / 1000), pBuf, TEXT_SIZE - 4);
+
+		AppendMilliseconds(pBuf + nLength, static_cast<uint32_t>(nMilliseconds % 1000));
+
+		return nLength + 4;
+	}
+
+	uint64_t LoggerClock::Ticks()
+	{
+#ifdef AUX_LOGGER_TSC
+		return __rdtsc();
+#else
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	double LoggerClock::GetTicksPerSecond()
+	{
+		static const double fTicksPerSecond = []()
+		{
+#ifdef AUX_LOGGER_TSC
+			auto t0 = std::chrono::steady_clock::now();
+			uint64_t n0 = Ticks();
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+			uint64_t n1 = Ticks();
+			auto t1 = std::chrono::steady_clock::now();
+
+			return (n1 - n0) / std::chrono::duration<double>(t1 - t0).count();
+#else
+			return 1e9;
+#endif
+		}();
+
+		return fTicksPerSecond;
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace aux
+{
+	// Timestamp service of the logger. A ticker thread formats the local time as
+	// "YYYY-MM-DD hh:mm:ss.mmm" every nInterval ms (the date and the time of day only when the second
+	// changes, the milliseconds every tick), readers copy the text without a lock: the ticker is the
+	// only writer of a sequence lock, a reader retries while the sequence is odd or has changed.
+	//
+	// Ticks() is a raw counter for high-resolution relative stamps: the time stamp counter on x86
+	// (assumed invariant, as on every CPU of the last decade), steady_clock nanoseconds elsewhere.
+	class LoggerClock
+	{
+	public:
+		static constexpr size_t TEXT_SIZE = 32;  // with the terminating zero
+
+	private:
+		std::atomic<uint32_t>   m_nSequence{ 0 };
+		std::atomic<uint64_t>   m_Text[TEXT_SIZE / sizeof(uint64_t)];
+
+		// Ticker:
+		uint32_t                m_nInterval;
+		std::thread             m_Ticker;
+		std::mutex              m_Mutex;
+		std::condition_variable m_Wake;
+		bool                    m_bStop{ false };
+		int64_t                 m_nSecond{ -1 };  // second of m_Prefix
+		char                    m_Prefix[TEXT_SIZE];
+		size_t                  m_nPrefix{ 0 };
+
+		void Update(std::chrono::system_clock::time_point t);
+
+		void TickerThread();
+
+		LoggerClock(uint32_t nInterval);
+
+	public:
+		~LoggerClock();
+
+		LoggerClock(const LoggerClock&) = delete;
+
+		LoggerClock& operator = (const LoggerClock&) = delete;
+
+		// Started on the first call, with a 1 ms interval.
+		static LoggerClock& Get();
+
+		// Copies the current timestamp with the terminating zero to pBuf (TEXT_SIZE bytes), returns its length.
+		size_t Read(char* pBuf) const;
+
+		std::string Now() const;
+
+		// Formats t the way the ticker does, without the cache; returns the length.
+		static size_t Format(std::chrono::system_clock::time_point t, char* pBuf);
+
+		static uint64_t Ticks();
+
+		// Measured on the first call (about 10 ms).
+		static double GetTicksPerSecond();
+	};
+}
@@ -0,0 +1,383 @@
+#include "auxLoggerFormat.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	struct FormatRegistry
+	{
+		std::mutex               Mutex;
+		std::vector<const char*> Formats;
+	};
+
+	FormatRegistry& GetFormatRegistry()
+	{
+		static FormatRegistry registry;
+
+		return registry;
+	}
+
+	// Reads values of the record one after another.
+	class RecordReader
+	{
+	private:
+		std::string_view m_Record;
+		size_t           m_nPos{ 0 };
+
+	public:
+		RecordReader(std::string_view record) : m_Record(record)
+		{
+		}
+
+		bool IsEnd() const { return m_nPos == m_Record.size(); }
+
+		template <typename T>
+		bool Read(T& value)
+		{
+			if (m_Record.size() - m_nPos < sizeof(T))
+			{
+				return false;
+			}
+
+			memcpy(&value, m_Record.data() + m_nPos, sizeof(T));
+			m_nPos += sizeof(T);
+
+			return true;
+		}
+
+		bool Read(std::string_view& s, size_t nLength)
+		{
+			if (m_Record.size() - m_nPos < nLength)
+			{
+				return false;
+			}
+
+			s = m_Record.substr(m_nPos, nLength);
+			m_nPos += nLength;
+
+			return true;
+		}
+	};
+
+	// UTC "YYYY-MM-DD hh:mm:ss.uuuuuu" without the C library (no gmtime_s / gmtime_r difference).
+	void AppendTime(std::string& s, int64_t nMicroseconds)
+	{
+		int64_t nSeconds = nMicroseconds / 1000000;
+		int64_t nFraction = nMicroseconds % 1000000;
+
+		if (nFraction < 0)
+		{
+			nFraction += 1000000;
+			--nSeconds;
+		}
+
+		int64_t nDays = nSeconds / 86400;
+		int64_t nTime = nSeconds % 86400;
+
+		if (nTime < 0)
+		{
+			nTime += 86400;
+			--nDays;
+		}
+
+		// Civil date from the day number (proleptic Gregorian calendar, eras of 400 years).
+		nDays += 719468;
+
+		int64_t nEra = ((nDays >= 0) ? nDays : nDays - 146096) / 146097;
+		int64_t nDayOfEra = nDays - nEra * 146097;
+		int64_t nYearOfEra = (nDayOfEra - nDayOfEra / 1460 + nDayOfEra / 36524 - nDayOfEra / 146096) / 365;
+		int64_t nDayOfYear = nDayOfEra - (365 * nYearOfEra + nYearOfEra / 4 - nYearOfEra / 100);
+		int64_t nMonth = (5 * nDayOfYear + 2) / 153;
+		int64_t nDay = nDayOfYear - (153 * nMonth + 2) / 5 + 1;
+
+		nMonth = (nMonth < 10) ? nMonth + 3 : nMonth - 9;
+
+		int64_t nYear = nYearOfEra + nEra * 400 + ((nMonth <= 2) ? 1 : 0);
+		char buf[64];
+
+		snprintf(buf, sizeof(buf), "%04" PRId64 "-%02" PRId64 "-%02" PRId64 " %02" PRId64 ":%02" PRId64 ":%02" PRId64 ".%06" PRId64,
+			nYear, nMonth, nDay, nTime / 3600, (nTime / 60) % 60, nTime % 60, nFraction);
+
+		s += buf;
+	}
+
+	// Appends the next argument of the record, FALSE if the record ends or is malformed.
+	bool AppendArgument(RecordReader& reader, std::string& s)
+	{
+		aux::LoggerArgType type;
+		char buf[64];
+
+		if (!reader.Read(type))
+		{
+			return false;
+		}
+
+		switch (type)
+		{
+		case aux::LoggerArgType::Int:
+		case aux::LoggerArgType::Time:
+		{
+			int64_t n;
+
+			if (!reader.Read(n))
+			{
+				return false;
+			}
+
+			if (type == aux::LoggerArgType::Time)
+			{
+				AppendTime(s, n);
+			}
+			else
+			{
+				s += std::to_string(n);
+			}
+
+			return true;
+		}
+
+		case aux::LoggerArgType::UInt:
+		case aux::LoggerArgType::Pointer:
+		{
+			uint64_t n;
+
+			if (!reader.Read(n))
+			{
+				return false;
+			}
+
+			if (type == aux::LoggerArgType::Pointer)
+			{
+				snprintf(buf, sizeof(buf), "0x%" PRIx64, n);
+				s += buf;
+			}
+			else
+			{
+				s += std::to_string(n);
+			}
+
+			return true;
+		}
+
+		case aux::LoggerArgType::Double:
+		{
+			double f;
+
+			if (!reader.Read(f))
+			{
+				return false;
+			}
+
+			snprintf(buf, sizeof(buf), "%g", f);
+			s += buf;
+
+			return true;
+		}
+
+		case aux::LoggerArgType::Bool:
+		{
+			uint8_t b;
+
+			if (!reader.Read(b))
+			{
+				return false;
+			}
+
+			s += (b) ? "true" : "false";
+
+			return true;
+		}
+
+		case aux::LoggerArgType::Char:
+		{
+			char c;
+
+			if (!reader.Read(c))
+			{
+				return false;
+			}
+
+			s += c;
+
+			return true;
+		}
+
+		case aux::LoggerArgType::String:
+		{
+			uint32_t nLength;
+			std::string_view text;
+
+			if ((!reader.Read(nLength)) || (!reader.Read(text, nLength)))
+			{
+				return false;
+			}
+
+			s += text;
+
+			return true;
+		}
+		}
+
+		return false;
+	}
+}
+
+namespace aux
+{
+	LoggerFormat::LoggerFormat(const char* pFormat) : m_nId(Register(pFormat)), m_pFormat(pFormat)
+	{
+	}
+
+	uint32_t LoggerFormat::Register(const char* pFormat)
+	{
+		FormatRegistry& registry = GetFormatRegistry();
+		std::lock_guard<std::mutex> lock(registry.Mutex);
+
+		registry.Formats.push_back(pFormat);
+
+		return static_cast<uint32_t>(registry.Formats.size() - 1);
+	}
+
+	const char* LoggerFormat::Find(uint32_t nId)
+	{
+		FormatRegistry& registry = GetFormatRegistry();
+		std::lock_guard<std::mutex> lock(registry.Mutex);
+
+		return (nId < registry.Formats.size()) ? registry.Formats[nId] : nullptr;
+	}
+
+	bool FormatLoggerRecord(std::string_view record, std::string& s, const char* pFormat)
+	{
+		RecordReader reader(record);
+		uint32_t nId;
+
+		if (!reader.Read(nId))
+		{
+			return false;
+		}
+
+		if ((!pFormat) && (!(pFormat = LoggerFormat::Find(nId))))
+		{
+			return false;
+		}
+
+		for (const char* p = pFormat; *p; ++p)
+		{
+			if ((p[0] == '{') && (p[1] == '}'))
+			{
+				if (!AppendArgument(reader, s))
+				{
+					return false;
+				}
+
+				++p;
+			}
+			else if (((p[0] == '{') && (p[1] == '{')) || ((p[0] == '}') && (p[1] == '}')))
+			{
+				s += *p++;
+			}
+			else
+			{
+				s += *p;
+			}
+		}
+
+		// More arguments than placeholders.
+		return reader.IsEnd();
+	}
+
+	void AppendLoggerFrame(std::string& s, LoggerFrame kind, std::string_view payload)
+	{
+		uint32_t nSize = static_cast<uint32_t>(payload.size());
+
+		s.append(reinterpret_cast<const char*>(&kind), sizeof(kind));
+		s.append(reinterpret_cast<const char*>(&nSize), sizeof(nSize));
+		s.append(payload.data(), payload.size());
+	}
+
+	bool DecodeLog(std::istream& is, std::ostream& os)
+	{
+		std::unordered_map<uint32_t, std::string> formats;
+		std::string payload;
+		std::string text;
+
+		for (;;)
+		{
+			LoggerFrame kind;
+			uint32_t nSize;
+
+			if (!is.read(reinterpret_cast<char*>(&kind), sizeof(kind)))
+			{
+				// End of the log.
+				return is.gcount() == 0;
+			}
+
+			if (!is.read(reinterpret_cast<char*>(&nSize), sizeof(nSize)))
+			{
+				return false;
+			}
+
+			payload.resize(nSize);
+
+			if ((nSize) && (!is.read(&payload[0], nSize)))
+			{
+				return false;
+			}
+
+			switch (kind)
+			{
+			case LoggerFrame::Text:
+				os << payload;
+				break;
+
+			case LoggerFrame::Format:
+			{
+				uint32_t nId;
+
+				if (nSize < sizeof(nId))
+				{
+					return false;
+				}
+
+				memcpy(&nId, payload.data(), sizeof(nId));
+				formats[nId] = payload.substr(sizeof(nId));
+				break;
+			}
+
+			case LoggerFrame::Record:
+			{
+				uint32_t nId;
+
+				if (nSize < sizeof(nId))
+				{
+					return false;
+				}
+
+				memcpy(&nId, payload.data(), sizeof(nId));
+
+				auto it = formats.find(nId);
+
+				text.clear();
+
+				bool bValid = (it != formats.end()) && (FormatLoggerRecord(payload, text, it->second.c_str()));
+
+				os << text;
+
+				if (!bValid)
+				{
+					return false;
+				}
+
+				break;
+			}
+
+			default:
+				return false;
+			}
+		}
+	}
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Binary log records: the logging thread stores the ID of a static format string and the raw bytes
+// of the arguments, the text is made later (by the background thread of the logger, or offline by
+// DecodeLog() from a binary log).
+//
+//	static const aux::LoggerFormat format("{}: loaded {} objects in {} ms\n");
+//
+//	aux::Logger::Get().Log(format, aux::LoggerTime::Now(), nObjects, ms);
+//
+// Every argument is stored as a type tag and its value, so a record is decoded with the format
+// string alone. Arguments are integers, enums, bool, char, floating point numbers, pointers,
+// strings (anything std::string_view is constructible from, the characters are copied) and
+// LoggerTime.
+
+namespace aux
+{
+	enum class LoggerArgType : uint8_t
+	{
+		Int = 0,     // int64_t
+		UInt = 1,    // uint64_t
+		Double = 2,  // double
+		Bool = 3,    // uint8_t
+		Char = 4,    // char
+		String = 5,  // uint32_t length, characters
+		Pointer = 6, // uint64_t
+		Time = 7     // int64_t microseconds since 1970-01-01 UTC
+	};
+
+	// Time of a record, formatted as UTC "YYYY-MM-DD hh:mm:ss.uuuuuu" when the text is made.
+	struct LoggerTime
+	{
+		int64_t nMicroseconds;
+
+		static LoggerTime Now()
+		{
+			return { std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::system_clock::now().time_since_epoch()).count() };
+		}
+	};
+
+	// Format string of binary records: "{}" is replaced by the next argument, "{{" and "}}" are
+	// braces. The ID is given at construction and is valid in this process only; the object and the
+	// string must live as long as the logger (static or function-local static objects).
+	class LoggerFormat
+	{
+	private:
+		uint32_t    m_nId;
+		const char* m_pFormat;
+
+	public:
+		explicit LoggerFormat(const char* pFormat);
+
+		LoggerFormat(const LoggerFormat&) = delete;
+
+		LoggerFormat& operator = (const LoggerFormat&) = delete;
+
+		uint32_t GetId() const { return m_nId; }
+
+		const char* GetFormat() const { return m_pFormat; }
+
+		// ID of a format string that lives as long as the logger; every call gives a new ID.
+		static uint32_t Register(const char* pFormat);
+
+		// nullptr for an unknown ID.
+		static const char* Find(uint32_t nId);
+	};
+
+	// Record being encoded: format ID, then the type tag and the value of every argument.
+	// Short records stay on the stack.
+	class LoggerRecordBuffer
+	{
+	private:
+		char        m_Local[256];
+		std::string m_Heap;
+		size_t      m_nSize{ 0 };
+
+	public:
+		void Append(const void* p, size_t nSize)
+		{
+			if ((m_Heap.empty()) && (m_nSize + nSize <= sizeof(m_Local)))
+			{
+				memcpy(m_Local + m_nSize, p, nSize);
+			}
+			else
+			{
+				if (m_Heap.empty())
+				{
+					m_Heap.assign(m_Local, m_nSize);
+				}
+
+				m_Heap.append(static_cast<const char*>(p), nSize);
+			}
+
+			m_nSize += nSize;
+		}
+
+		template <typename T>
+		void Append(LoggerArgType type, T value)
+		{
+			Append(&type, sizeof(type));
+			Append(&value, sizeof(value));
+		}
+
+		std::string_view GetView() const
+		{
+			return (m_Heap.empty()) ? std::string_view(m_Local, m_nSize) : std::string_view(m_Heap);
+		}
+	};
+
+	template <typename T>
+	void PutLoggerArgument(LoggerRecordBuffer& buffer, const T& value)
+	{
+		if constexpr (std::is_same_v<T, LoggerTime>)
+		{
+			buffer.Append(LoggerArgType::Time, value.nMicroseconds);
+		}
+		else if constexpr (std::is_same_v<T, bool>)
+		{
+			buffer.Append(LoggerArgType::Bool, static_cast<uint8_t>(value));
+		}
+		else if constexpr (std::is_same_v<T, char>)
+		{
+			buffer.Append(LoggerArgType::Char, value);
+		}
+		else if constexpr (std::is_enum_v<T>)
+		{
+			buffer.Append(LoggerArgType::Int, static_cast<int64_t>(value));
+		}
+		else if constexpr ((std::is_integral_v<T>) && (std::is_signed_v<T>))
+		{
+			buffer.Append(LoggerArgType::Int, static_cast<int64_t>(value));
+		}
+		else if constexpr (std::is_integral_v<T>)
+		{
+			buffer.Append(LoggerArgType::UInt, static_cast<uint64_t>(value));
+		}
+		else if constexpr (std::is_floating_point_v<T>)
+		{
+			buffer.Append(LoggerArgType::Double, static_cast<double>(value));
+		}
+		else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+		{
+			std::string_view s(value);
+			uint32_t nLength = static_cast<uint32_t>(s.size());
+
+			buffer.Append(LoggerArgType::String, nLength);
+			buffer.Append(s.data(), nLength);
+		}
+		else if constexpr (std::is_pointer_v<T>)
+		{
+			buffer.Append(LoggerArgType::Pointer, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+		}
+		else
+		{
+			static_assert(std::is_same_v<T, LoggerTime>, "aux::Logger: unsupported argument type");
+		}
+	}
+
+	// Appends the text of an encoded record to s, FALSE if the record is malformed
+	// (the text made so far is kept). pFormat == nullptr - the format is looked up by its ID.
+	bool FormatLoggerRecord(std::string_view record, std::string& s, const char* pFormat = nullptr);
+
+	// Frames of a binary log: uint8_t kind, uint32_t payload size, payload.
+	enum class LoggerFrame : uint8_t
+	{
+		Text = 0,    // text as it was logged
+		Record = 1,  // encoded record
+		Format = 2   // uint32_t format ID, format string; precedes the first record with this ID
+	};
+
+	void AppendLoggerFrame(std::string& s, LoggerFrame kind, std::string_view payload);
+
+	// Converts a binary log to text. FALSE on a malformed frame or record (the text before it is written).
+	bool DecodeLog(std::istream& is, std::ostream& os);
+}
@@ -0,0 +1,88 @@
+#include "auxMappedFile.h"
+#include "windows.h"
+
+#include <cstdint>
+
+namespace aux
+{
+	MappedFile::MappedFile() : m_hFile(nullptr), m_hMapping(nullptr), m_pData(nullptr), m_nSize(0)
+	{
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	bool MappedFile::Open(const std::string& fileName)
+	{
+		Close();
+
+		HANDLE hFile = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+		if (hFile == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		m_hFile = hFile;
+
+		LARGE_INTEGER size;
+
+		if ((!GetFileSizeEx(hFile, &size)) || (static_cast<uint64_t>(size.QuadPart) > SIZE_MAX))
+		{
+			Close();
+			return false;
+		}
+
+		if (!size.QuadPart)
+		{
+			// Empty files can't be mapped.
+			return true;
+		}
+
+		m_hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (!m_hMapping)
+		{
+			Close();
+			return false;
+		}
+
+		m_pData = static_cast<const char*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+
+		if (!m_pData)
+		{
+			Close();
+			return false;
+		}
+
+		m_nSize = static_cast<size_t>(size.QuadPart);
+
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_pData)
+		{
+			UnmapViewOfFile(m_pData);
+		}
+
+		if (m_hMapping)
+		{
+			CloseHandle(m_hMapping);
+		}
+
+		if (m_hFile)
+		{
+			CloseHandle(m_hFile);
+		}
+
+		m_hFile = nullptr;
+		m_hMapping = nullptr;
+		m_pData = nullptr;
+		m_nSize = 0;
+	}
+}
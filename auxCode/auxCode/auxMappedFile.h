@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace aux
+{
+	// Read-only view of a whole file mapped into memory. The view is valid until Close() or
+	// the destructor; an empty file gives an empty view.
+	class MappedFile
+	{
+	private:
+		void*       m_hFile;
+		void*       m_hMapping;
+		const char* m_pData;
+		size_t      m_nSize;
+
+	public:
+		MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+
+		MappedFile& operator = (const MappedFile&) = delete;
+
+		~MappedFile();
+
+		// FALSE if the file can't be opened or mapped.
+		bool Open(const std::string& fileName);
+
+		void Close();
+
+		bool IsOpen() const { return (m_hFile != nullptr); }
+
+		const char* GetData() const { return m_pData; }
+
+		size_t GetSize() const { return m_nSize; }
+
+		std::string_view GetView() const { return std::string_view(m_pData, m_nSize); }
+	};
+}
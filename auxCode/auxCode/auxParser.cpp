@@ -1,4 +1,85 @@
 #include "auxParser.h"
+#include "auxMappedFile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <exception>
+#include <thread>
+#include <utility>
+
+namespace
+{
+	// Literal text every line matching the pattern starts with (regex_match matches the whole
+	// line). Stops at the first construct that is not a fixed character; returns "" when the
+	// pattern has an alternation, since the branches may start differently.
+	std::string GetLiteralPrefix(const std::string& pattern)
+	{
+		const char* pMeta = ".[]{}()*+?|^$\\";
+		const char* pQuantifier = "*+?{";
+
+		bool bClass = false;
+
+		for (size_t i = 0; i < pattern.size(); ++i)
+		{
+			if (pattern[i] == '\\')
+			{
+				++i;
+			}
+			else if (pattern[i] == '[')
+			{
+				bClass = true;
+			}
+			else if (pattern[i] == ']')
+			{
+				bClass = false;
+			}
+			else if ((pattern[i] == '|') && (!bClass))
+			{
+				return std::string();
+			}
+		}
+
+		std::string prefix;
+		size_t i = ((pattern.size()) && (pattern[0] == '^')) ? 1 : 0;
+
+		while (i < pattern.size())
+		{
+			char c = pattern[i];
+			size_t next = i + 1;
+
+			if (c == '\\')
+			{
+				// \d, \w, \b, \1, ... are not literals.
+				if ((next >= pattern.size()) || (std::isalnum(static_cast<unsigned char>(pattern[next]))))
+				{
+					break;
+				}
+
+				c = pattern[next++];
+			}
+			else if (std::strchr(pMeta, c))
+			{
+				break;
+			}
+
+			// Quantified character may be missing (or repeated) in the line.
+			if ((next < pattern.size()) && (std::strchr(pQuantifier, pattern[next])))
+			{
+				break;
+			}
+
+			prefix += c;
+			i = next;
+		}
+
+		return prefix;
+	}
+
+	// Chunk of the parallel parse the thread works on.
+	thread_local uint32_t t_nChunk = 0;
+}
 
 namespace aux
 {
@@ -17,50 +98,91 @@ namespace aux
 	ParserElement::ParserElement(std::regex begin, std::function<ParserHandler> beginHandler,
 		std::regex end, std::function<ParserHandler> endHandler,
 		const std::initializer_list<ParserElement>& innerElements)
+		: ParserElement(std::make_shared<RegexMatcher>(std::move(begin)), beginHandler,
+			std::make_shared<RegexMatcher>(std::move(end)), endHandler, innerElements)
+	{
+	}
+
+	ParserElement::ParserElement(std::regex element, std::function<ParserHandler> handler)
+		: ParserElement(std::make_shared<RegexMatcher>(std::move(element)), handler)
+	{
+	}
+
+	ParserElement::ParserElement(const std::string& begin, std::function<ParserHandler> beginHandler,
+		const std::string& end, std::function<ParserHandler> endHandler,
+		const std::initializer_list<ParserElement>& innerElements)
+		: ParserElement(MakeParserMatcher(begin), beginHandler, MakeParserMatcher(end), endHandler, innerElements)
+	{
+	}
+
+	ParserElement::ParserElement(const std::string& element, std::function<ParserHandler> handler)
+		: ParserElement(MakeParserMatcher(element), handler)
+	{
+	}
+
+	ParserElement::ParserElement(std::shared_ptr<const ParserMatcher> begin, std::function<ParserHandler> beginHandler,
+		std::shared_ptr<const ParserMatcher> end, std::function<ParserHandler> endHandler,
+		const std::initializer_list<ParserElement>& innerElements)
 	{
 		m_Type = ParserElementType::GroupElement;
 
-		m_RegexBegin = begin;
+		m_MatcherBegin = std::move(begin);
 		m_BeginHandler = beginHandler;
 
-		m_RegexEnd = end;
+		m_MatcherEnd = std::move(end);
 		m_EndHandler = endHandler;
 
 		m_ChildElements.assign(innerElements);
+
+		SetPrefixes();
 	}
 
-	ParserElement::ParserElement(std::regex element, std::function<ParserHandler> handler)
+	ParserElement::ParserElement(std::shared_ptr<const ParserMatcher> element, std::function<ParserHandler> handler)
 	{
 		m_Type = ParserElementType::SingleElement;
 
-		m_RegexBegin = element;
+		m_MatcherBegin = std::move(element);
 		m_BeginHandler = handler;
+
+		SetPrefixes();
 	}
 
 	ParserElement::ParserElement(const ParserElement& other)
 	{
 		m_Type = other.m_Type;
 		
-		m_RegexBegin = other.m_RegexBegin;
-		m_RegexEnd = other.m_RegexEnd;
+		m_MatcherBegin = other.m_MatcherBegin;
+		m_MatcherEnd = other.m_MatcherEnd;
+
+		m_PrefixBegin = other.m_PrefixBegin;
+		m_PrefixEnd = other.m_PrefixEnd;
 
 		m_BeginHandler = other.m_BeginHandler;
 		m_EndHandler = other.m_EndHandler;
 
 		m_ChildElements = other.m_ChildElements;
+
+		m_Dispatch = other.m_Dispatch;
+		m_Unprefixed = other.m_Unprefixed;
 	}
 
 	ParserElement::ParserElement(ParserElement&& other)
 	{
 		m_Type = std::exchange(other.m_Type, ParserElementType::EmptyElement);
 
-		m_RegexBegin = std::move(other.m_RegexBegin);
-		m_RegexEnd = std::move(other.m_RegexEnd);
+		m_MatcherBegin = std::move(other.m_MatcherBegin);
+		m_MatcherEnd = std::move(other.m_MatcherEnd);
+
+		m_PrefixBegin = std::move(other.m_PrefixBegin);
+		m_PrefixEnd = std::move(other.m_PrefixEnd);
 
 		m_BeginHandler = std::move(other.m_BeginHandler);
 		m_EndHandler = std::move(other.m_EndHandler);
 
 		m_ChildElements = std::move(other.m_ChildElements);
+
+		m_Dispatch = std::move(other.m_Dispatch);
+		m_Unprefixed = std::move(other.m_Unprefixed);
 	}
 
 	ParserElement& ParserElement::operator = (const ParserElement& other)
@@ -69,13 +191,19 @@ namespace aux
 		{
 			m_Type = other.m_Type;
 
-			m_RegexBegin = other.m_RegexBegin;
-			m_RegexEnd = other.m_RegexEnd;
+			m_MatcherBegin = other.m_MatcherBegin;
+			m_MatcherEnd = other.m_MatcherEnd;
+
+			m_PrefixBegin = other.m_PrefixBegin;
+			m_PrefixEnd = other.m_PrefixEnd;
 
 			m_BeginHandler = other.m_BeginHandler;
 			m_EndHandler = other.m_EndHandler;
 
 			m_ChildElements = other.m_ChildElements;
+
+			m_Dispatch = other.m_Dispatch;
+			m_Unprefixed = other.m_Unprefixed;
 		}
 
 		return *this;
@@ -87,26 +215,482 @@ namespace aux
 		{
 			m_Type = std::exchange(other.m_Type, ParserElementType::EmptyElement);
 
-			m_RegexBegin = std::move(other.m_RegexBegin);
-			m_RegexEnd = std::move(other.m_RegexEnd);
+			m_MatcherBegin = std::move(other.m_MatcherBegin);
+			m_MatcherEnd = std::move(other.m_MatcherEnd);
+
+			m_PrefixBegin = std::move(other.m_PrefixBegin);
+			m_PrefixEnd = std::move(other.m_PrefixEnd);
 
 			m_BeginHandler = std::move(other.m_BeginHandler);
 			m_EndHandler = std::move(other.m_EndHandler);
 
 			m_ChildElements = std::move(other.m_ChildElements);
+
+			m_Dispatch = std::move(other.m_Dispatch);
+			m_Unprefixed = std::move(other.m_Unprefixed);
 		}
 
 		return *this;
 	}
 
-	StringParser::StringParser()
+	void ParserElement::SetPrefixes()
+	{
+		// Dispatch compares characters as they are, so caseless patterns have no prefix.
+		if ((m_MatcherBegin) && (!m_MatcherBegin->IsCaseless()))
+		{
+			m_PrefixBegin = GetLiteralPrefix(m_MatcherBegin->GetPattern());
+		}
+
+		if ((m_MatcherEnd) && (!m_MatcherEnd->IsCaseless()))
+		{
+			m_PrefixEnd = GetLiteralPrefix(m_MatcherEnd->GetPattern());
+		}
+	}
+
+	void ParserElement::Compile()
+	{
+		m_Dispatch.assign(1, ParserDispatchNode());
+		m_Unprefixed.clear();
+
+		for (uint32_t i = 0; i < m_ChildElements.size(); ++i)
+		{
+			ParserElement& e = m_ChildElements[i];
+
+			e.Compile();
+
+			if (e.m_PrefixBegin.empty())
+			{
+				m_Unprefixed.push_back(i);
+				continue;
+			}
+
+			uint32_t node = 0;
+
+			for (char c : e.m_PrefixBegin)
+			{
+				auto it = m_Dispatch[node].Next.find(c);
+
+				if (it == m_Dispatch[node].Next.end())
+				{
+					m_Dispatch.emplace_back();
+					it = m_Dispatch[node].Next.emplace(c, static_cast<uint32_t>(m_Dispatch.size() - 1)).first;
+				}
+
+				node = it->second;
+			}
+
+			m_Dispatch[node].Elements.push_back(i);
+		}
+	}
+
+	void ParserElement::Select(std::string_view s, std::vector<uint32_t>& candidates) const
 	{
+		if (m_Dispatch.empty())
+		{
+			// Not compiled: every child is a candidate.
+			candidates.resize(m_ChildElements.size());
+
+			for (uint32_t i = 0; i < candidates.size(); ++i)
+			{
+				candidates[i] = i;
+			}
+
+			return;
+		}
+
+		candidates.assign(m_Unprefixed.cbegin(), m_Unprefixed.cend());
+
+		// Walk the line down the trie, every node passed is a prefix of the line.
+		uint32_t node = 0;
+
+		for (size_t i = 0; ; ++i)
+		{
+			candidates.insert(candidates.end(), m_Dispatch[node].Elements.cbegin(), m_Dispatch[node].Elements.cend());
+
+			if (i >= s.size())
+			{
+				break;
+			}
+
+			auto it = m_Dispatch[node].Next.find(s[i]);
 
+			if (it == m_Dispatch[node].Next.end())
+			{
+				break;
+			}
+
+			node = it->second;
+		}
+
+		// The first matching child wins, so keep the declaration order.
+		if (candidates.size() > 1)
+		{
+			std::sort(candidates.begin(), candidates.end());
+		}
+	}
+
+	ParserLineIterator::ParserLineIterator(std::string_view text)
+		: m_pNext(text.data()), m_pEnd(text.data() + text.size())
+	{
+		Advance();
+	}
+
+	void ParserLineIterator::Advance()
+	{
+		if ((!m_pNext) || (m_pNext == m_pEnd))
+		{
+			// No text after the last line break.
+			m_pNext = nullptr;
+			m_Line = std::string_view();
+
+			return;
+		}
+
+		const char* pBreak = static_cast<const char*>(std::memchr(m_pNext, '\n', m_pEnd - m_pNext));
+		const char* pLineEnd = (pBreak) ? pBreak : m_pEnd;
+
+		m_Line = std::string_view(m_pNext, pLineEnd - m_pNext);
+
+		if ((m_Line.size()) && (m_Line.back() == '\r'))
+		{
+			m_Line.remove_suffix(1);
+		}
+
+		m_pNext = (pBreak) ? (pBreak + 1) : m_pEnd;
+	}
+
+	StringParser::StringParser() : m_bParallel(false), m_nThreads(0)
+	{
+
+	}
+
+	void StringParser::SetParallel(bool bParallel, uint32_t nThreads)
+	{
+		m_bParallel = bParallel;
+		m_nThreads = nThreads;
+	}
+
+	uint32_t StringParser::GetChunk() const
+	{
+		return t_nChunk;
+	}
+
+	void StringParser::OnParallelBegin(uint32_t)
+	{
+	}
+
+	void StringParser::OnParallelEnd(uint32_t)
+	{
+	}
+
+	void StringParser::ParseLine(std::string_view s, ParserState& state) const
+	{
+		ParserElement* pTop = state.Elements.top();
+
+		pTop->Select(s, state.Candidates);
+
+		for (uint32_t i : state.Candidates)
+		{
+			auto &e = pTop->m_ChildElements[i];
+
+			if (e.m_MatcherBegin->Match(s, state.Match))
+			{
+				// Elements without a handler are allowed (nullptr).
+				if (e.m_BeginHandler)
+				{
+					e.m_BeginHandler(*this, state.Match);
+				}
+
+				if (e.m_Type == ParserElementType::GroupElement)
+				{
+					state.Elements.push(&e);
+				}
+
+				return;
+			}
+		}
+
+		if ((pTop->m_Type == ParserElementType::GroupElement) && (pTop->MayEnd(s)))
+		{
+			if (pTop->m_MatcherEnd->Match(s, state.Match))
+			{
+				if (pTop->m_EndHandler)
+				{
+					pTop->m_EndHandler(*this, state.Match);
+				}
+
+				state.Elements.pop();
+			}
+		}
+	}
+
+	void StringParser::ScanLine(std::string_view s, ParserState& state) const
+	{
+		ParserElement* pTop = state.Elements.top();
+
+		pTop->Select(s, state.Candidates);
+
+		const size_t nCandidates = state.Candidates.size();
+		size_t nGroup = nCandidates;
+
+		for (size_t n = 0; n < nCandidates; ++n)
+		{
+			auto &e = pTop->m_ChildElements[state.Candidates[n]];
+
+			if ((e.m_Type == ParserElementType::GroupElement) && (e.m_MatcherBegin->Test(s, state.Match)))
+			{
+				nGroup = n;
+				break;
+			}
+		}
+
+		// The end is tested only if no child takes the line.
+		bool bEnd = (nGroup == nCandidates) && (pTop->m_Type == ParserElementType::GroupElement) && (pTop->MayEnd(s)) &&
+			(pTop->m_MatcherEnd->Test(s, state.Match));
+
+		if ((nGroup == nCandidates) && (!bEnd))
+		{
+			return;
+		}
+
+		for (size_t n = 0; n < nGroup; ++n)
+		{
+			auto &e = pTop->m_ChildElements[state.Candidates[n]];
+
+			if ((e.m_Type != ParserElementType::GroupElement) && (e.m_MatcherBegin->Test(s, state.Match)))
+			{
+				return;
+			}
+		}
+
+		if (nGroup < nCandidates)
+		{
+			state.Elements.push(&pTop->m_ChildElements[state.Candidates[nGroup]]);
+		}
+		else
+		{
+			state.Elements.pop();
+		}
+	}
+
+	bool StringParser::IsRootLine(std::string_view s, ParserState& state) const
+	{
+		m_RootElement.Select(s, state.Candidates);
+
+		for (uint32_t i : state.Candidates)
+		{
+			if (m_RootElement.m_ChildElements[i].m_MatcherBegin->Test(s, state.Match))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void StringParser::ParseParallel(std::string_view text)
+	{
+		uint32_t nThreads = (m_nThreads) ? m_nThreads : std::max(1u, std::thread::hardware_concurrency());
+
+		// A few chunks per thread even out chunks of different cost.
+		const size_t nChunkSize = std::max<size_t>(text.size() / (static_cast<size_t>(nThreads) * 4), 1);
+		const char* pEnd = text.data() + text.size();
+
+		// Runs task(n, thread) for n = 0..nTasks-1 on the threads. An exception stops the tasks
+		// not yet started; the one of the first task in the document is rethrown.
+		auto run = [nThreads](uint32_t nTasks, const std::function<void(uint32_t, uint32_t)>& task)
+		{
+			std::atomic<uint32_t> nNext{ 0 };
+			std::atomic<bool> bFailed{ false };
+			std::vector<std::exception_ptr> vecErrors(nTasks);
+			std::vector<std::thread> vecThreads;
+
+			for (uint32_t t = 0; t < std::min(nThreads, nTasks); ++t)
+			{
+				vecThreads.emplace_back([&task, &nNext, &bFailed, &vecErrors, nTasks, t]()
+				{
+					for (uint32_t n = nNext++; (n < nTasks) && (!bFailed); n = nNext++)
+					{
+						try
+						{
+							task(n, t);
+						}
+						catch (...)
+						{
+							vecErrors[n] = std::current_exception();
+							bFailed = true;
+						}
+					}
+				});
+			}
+
+			for (auto& thread : vecThreads)
+			{
+				thread.join();
+			}
+
+			for (auto& error : vecErrors)
+			{
+				if (error)
+				{
+					std::rethrow_exception(error);
+				}
+			}
+		};
+
+		// Slices of about nChunkSize bytes, starting at lines.
+		std::vector<const char*> vecSlices{ text.data() };
+
+		for (size_t nPos = nChunkSize; nPos < text.size(); nPos += nChunkSize)
+		{
+			const char* pBreak = static_cast<const char*>(std::memchr(text.data() + nPos - 1, '\n', pEnd - (text.data() + nPos - 1)));
+
+			if ((!pBreak) || (pBreak + 1 == pEnd))
+			{
+				break;
+			}
+
+			if (pBreak + 1 > vecSlices.back())
+			{
+				vecSlices.push_back(pBreak + 1);
+			}
+		}
+
+		vecSlices.push_back(pEnd);
+
+		// Guess: a chunk starts at the first line of a slice that matches a child of the root.
+		const uint32_t nSlices = static_cast<uint32_t>(vecSlices.size() - 1);
+		std::vector<ParserState> vecStates(std::max(nThreads, nSlices));
+		std::vector<const char*> vecGuesses(nSlices, nullptr);
+
+		vecGuesses[0] = text.data();
+
+		run(nSlices - 1, [this, &vecSlices, &vecStates, &vecGuesses](uint32_t n, uint32_t t)
+		{
+			std::string_view slice(vecSlices[n + 1], vecSlices[n + 2] - vecSlices[n + 1]);
+
+			for (ParserLineIterator it(slice), end; it != end; ++it)
+			{
+				if (IsRootLine(*it, vecStates[t]))
+				{
+					vecGuesses[n + 1] = it->data();
+					break;
+				}
+			}
+		});
+
+		std::vector<const char*> vecStarts;
+
+		std::copy_if(vecGuesses.cbegin(), vecGuesses.cend(), std::back_inserter(vecStarts), [](const char* p) { return p != nullptr; });
+		vecStarts.push_back(pEnd);
+
+		// Every chunk is scanned from the top level; vecStates[n] is the position at its end.
+		const uint32_t nGuessed = static_cast<uint32_t>(vecStarts.size() - 1);
+
+		run(nGuessed, [this, &vecStarts, &vecStates](uint32_t n, uint32_t)
+		{
+			ParserState& state = vecStates[n];
+
+			state.Reset(&m_RootElement);
+
+			for (ParserLineIterator it(std::string_view(vecStarts[n], vecStarts[n + 1] - vecStarts[n])), end; it != end; ++it)
+			{
+				ScanLine(*it, state);
+			}
+		});
+
+		// A guess holds if the chunk before it ends at the top level. A chunk after a wrong guess
+		// is scanned again from the true position; its first top-level line starts the next chunk.
+		std::vector<const char*> vecBounds{ text.data() };
+
+		m_State.Reset(&m_RootElement);
+
+		for (uint32_t n = 0; n < nGuessed; ++n)
+		{
+			if (m_State.Elements.size() == 1)
+			{
+				if (n)
+				{
+					vecBounds.push_back(vecStarts[n]);
+				}
+
+				m_State.Elements = vecStates[n].Elements;
+
+				continue;
+			}
+
+			for (ParserLineIterator it(std::string_view(vecStarts[n], vecStarts[n + 1] - vecStarts[n])), end; it != end; ++it)
+			{
+				if ((m_State.Elements.size() == 1) && (vecBounds.back() < vecStarts[n]))
+				{
+					vecBounds.push_back(it->data());
+				}
+
+				ScanLine(*it, m_State);
+			}
+		}
+
+		vecBounds.push_back(pEnd);
+
+		const uint32_t nChunks = static_cast<uint32_t>(vecBounds.size() - 1);
+
+		OnParallelBegin(nChunks);
+
+		run(nChunks, [this, &vecBounds, &vecStates](uint32_t n, uint32_t t)
+		{
+			ParserState& state = vecStates[t];
+
+			t_nChunk = n;
+			state.Reset(&m_RootElement);
+
+			for (ParserLineIterator it(std::string_view(vecBounds[n], vecBounds[n + 1] - vecBounds[n])), end; it != end; ++it)
+			{
+				ParseLine(*it, state);
+			}
+
+			t_nChunk = 0;
+		});
+
+		OnParallelEnd(nChunks);
 	}
 
 	void StringParser::Init(const std::initializer_list<ParserElement> &e)
 	{
 		m_RootElement = ParserElement(e);
+		m_RootElement.Compile();
+	}
+
+	void StringParser::Init(const std::vector<ParserElement>& e)
+	{
+		m_RootElement = ParserElement(std::initializer_list<ParserElement>());
+		m_RootElement.m_ChildElements = e;
+		m_RootElement.Compile();
+	}
+
+	void StringParser::ParseBuffer(std::string_view text)
+	{
+		if (m_bParallel)
+		{
+			ParseParallel(text);
+		}
+		else
+		{
+			Parse(ParserLineIterator(text), ParserLineIterator());
+		}
+	}
+
+	bool StringParser::ParseFile(const std::string& fileName)
+	{
+		MappedFile file;
+
+		if (!file.Open(fileName))
+		{
+			return false;
+		}
+
+		ParseBuffer(file.GetView());
+
+		return true;
 	}
 
 }
\ No newline at end of file
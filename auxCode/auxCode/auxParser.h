@@ -3,7 +3,13 @@
 #include <iostream>
 #include <regex>
 #include <functional>
+#include <iterator>
+#include <map>
 #include <stack>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "auxParserMatcher.h"
 
 namespace aux
 {
@@ -17,7 +23,14 @@ namespace aux
 
 	class StringParser;
 
-	using ParserHandler = bool (const StringParser&, const std::smatch&);
+	using ParserHandler = bool (const StringParser&, const ParserMatch&);
+
+	// Node of the first-token dispatch trie over literal prefixes of child elements.
+	struct ParserDispatchNode
+	{
+		std::map<char, uint32_t> Next;
+		std::vector<uint32_t>    Elements;  // children whose prefix ends at this node
+	};
 
 	struct ParserElement
 	{
@@ -25,14 +38,37 @@ namespace aux
 
 	private:
 		ParserElementType m_Type;
-		std::regex        m_RegexBegin;
-		std::regex        m_RegexEnd;
+
+		std::shared_ptr<const ParserMatcher> m_MatcherBegin;
+		std::shared_ptr<const ParserMatcher> m_MatcherEnd;
+
+		// Literal prefixes of the patterns ("" - unknown: std::regex and caseless patterns).
+		std::string       m_PrefixBegin;
+		std::string       m_PrefixEnd;
 		
 		std::function<ParserHandler> m_BeginHandler;
 		std::function<ParserHandler> m_EndHandler;
 
 		std::vector<ParserElement>   m_ChildElements;
 
+		// Built by Compile(): trie over the begin prefixes of children ([0] - root) and
+		// children without a prefix, which are tested for every line.
+		std::vector<ParserDispatchNode> m_Dispatch;
+		std::vector<uint32_t>           m_Unprefixed;
+
+		void SetPrefixes();
+
+		void Compile();
+
+		// Indexes of children that may match the line, in declaration order.
+		void Select(std::string_view s, std::vector<uint32_t>& candidates) const;
+
+		// FALSE if the line can't match the end pattern.
+		bool MayEnd(std::string_view s) const
+		{
+			return (s.compare(0, m_PrefixEnd.size(), m_PrefixEnd) == 0);
+		}
+
 	public:
 		ParserElement();
 		
@@ -44,6 +80,22 @@ namespace aux
 
 		ParserElement(std::regex element, std::function<ParserHandler> handler);
 
+		// Same as above, but the patterns are kept as text: their literal prefixes take part
+		// in the dispatch, so a line is tested only against children it can match. Patterns run
+		// on DfaMatcher when they fit its subset, on std::regex otherwise.
+		ParserElement(const std::string& begin, std::function<ParserHandler> beginHandler,
+			const std::string& end, std::function<ParserHandler> endHandler,
+			const std::initializer_list<ParserElement>& innerElements);
+
+		ParserElement(const std::string& element, std::function<ParserHandler> handler);
+
+		// Patterns with an explicit engine (see MakeParserMatcher()) or a custom matcher.
+		ParserElement(std::shared_ptr<const ParserMatcher> begin, std::function<ParserHandler> beginHandler,
+			std::shared_ptr<const ParserMatcher> end, std::function<ParserHandler> endHandler,
+			const std::initializer_list<ParserElement>& innerElements);
+
+		ParserElement(std::shared_ptr<const ParserMatcher> element, std::function<ParserHandler> handler);
+
 		ParserElement(const ParserElement& other);
 
 		ParserElement(ParserElement&& other);
@@ -54,70 +106,145 @@ namespace aux
 
 	};
 
+	// Forward iterator over the lines of a text buffer ("\n" or "\r\n" ends a line). Lines are
+	// views into the buffer; a default constructed iterator is the end.
+	class ParserLineIterator
+	{
+	private:
+		const char*      m_pNext;  // start of the next line, nullptr - end
+		const char*      m_pEnd;
+		std::string_view m_Line;
+
+		void Advance();
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = std::string_view;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const std::string_view*;
+		using reference = const std::string_view&;
+
+		ParserLineIterator() : m_pNext(nullptr), m_pEnd(nullptr)
+		{
+		}
+
+		explicit ParserLineIterator(std::string_view text);
+
+		reference operator * () const { return m_Line; }
+
+		pointer operator -> () const { return &m_Line; }
+
+		ParserLineIterator& operator ++ ()
+		{
+			Advance();
+
+			return *this;
+		}
+
+		ParserLineIterator operator ++ (int)
+		{
+			ParserLineIterator it = *this;
+
+			Advance();
+
+			return it;
+		}
+
+		bool operator == (const ParserLineIterator& other) const
+		{
+			return (m_pNext == other.m_pNext) && (m_Line.data() == other.m_Line.data());
+		}
+
+		bool operator != (const ParserLineIterator& other) const { return !(*this == other); }
+	};
+
+	// Position of a pass over the lines in the element tree and the working memory of the matchers.
+	// Every thread of a parallel parse has its own.
+	struct ParserState
+	{
+		std::stack<ParserElement*, std::vector<ParserElement*>> Elements;
+		std::vector<uint32_t>                                   Candidates;
+		ParserMatch                                             Match;
+
+		// Keeps the memory, so parsing many small files doesn't allocate per file.
+		void Reset(ParserElement* pRoot)
+		{
+			while (!Elements.empty())
+			{
+				Elements.pop();
+			}
+
+			Elements.push(pRoot);
+		}
+	};
+
 	class StringParser
 	{
 	private:
-		ParserElement  m_RootElement;
-	
+		ParserElement m_RootElement;
+		ParserState   m_State;
+
+		bool          m_bParallel;
+		uint32_t      m_nThreads;
+
+		void ParseLine(std::string_view s, ParserState& state) const;
+
+		// Follows the line in the element tree without handlers. Only groups change the position,
+		// so a line is tested against the group patterns, and against the other children only
+		// when it opens or closes a group (a child before the group may take the line).
+		void ScanLine(std::string_view s, ParserState& state) const;
+
+		// TRUE if the line matches a child of the root (it is likely a top-level line).
+		bool IsRootLine(std::string_view s, ParserState& state) const;
+
+		void ParseParallel(std::string_view text);
+
+	protected:
+		// Parallel parse: called before the chunks are started and after all of them are done.
+		// A grammar whose handlers collect results keeps them per chunk (see GetChunk()) and joins
+		// them in OnParallelEnd() in chunk order, which is document order.
+		virtual void OnParallelBegin(uint32_t nChunks);
+
+		virtual void OnParallelEnd(uint32_t nChunks);
+
 	public:
 		StringParser();
 
+		virtual ~StringParser() {}
+
 		void Init(const std::initializer_list<ParserElement>& e);
 
+		// Same for a grammar assembled at run time.
+		void Init(const std::vector<ParserElement>& e);
+
+		// Opt-in for grammars whose handlers are thread-safe. ParseBuffer() and ParseFile() then
+		// split the text into chunks at top-level lines and parse them on nThreads threads (0 - one
+		// per core), each with its own element stack. Handlers of different chunks run concurrently,
+		// within a chunk in order. The split is guessed in slices of the text (the first line of a
+		// slice that matches a child of the root) and checked by a parallel pass that tests only the
+		// group patterns; a slice after a wrong guess is scanned again from the true position.
+		void SetParallel(bool bParallel, uint32_t nThreads = 0);
+
+		// Chunk the handler is called for: 0..nChunks-1 in a parallel parse, 0 otherwise.
+		uint32_t GetChunk() const;
+
+		// Lines of a buffer in memory. Handlers get the groups as views into text, so a line
+		// is parsed without a copy.
+		void ParseBuffer(std::string_view text);
+
+		// Same over a memory-mapped file. FALSE if the file can't be opened or mapped.
+		bool ParseFile(const std::string& fileName);
+
+		// Lines are anything std::string_view is constructible from (std::string, std::string_view,
+		// const char*); the line is not copied. Always on the calling thread.
 		template <typename IT>
 		void Parse(IT itbegin, IT itend)
 		{
-			std::stack<ParserElement*> es;
-
-			es.push(&m_RootElement);
-
-			std::smatch base_match;
-			bool processed;
-			typename IT::value_type s;
+			m_State.Reset(&m_RootElement);
 
-			for (IT it = itbegin; it < itend; ++it)
+			for (IT it = itbegin; it != itend; ++it)
 			{
-				s = *it;
-				processed = false;
-
-				for(auto &e : es.top()->m_ChildElements)
-				{
-					if (std::regex_match(s, base_match, e.m_RegexBegin))
-					{
-						try
-						{
-							e.m_BeginHandler(*this, base_match);
-						} 
-						catch (std::bad_function_call e)
-						{
-						}
-
-						if (e.m_Type == ParserElementType::GroupElement)
-						{
-							es.push(&e);
-						}
-
-						processed = true;
-
-						break;
-					}
-				}
-
-				if ( (es.top()->m_Type == ParserElementType::GroupElement) && (!processed))
-				{
-					if (std::regex_match(s, base_match, es.top()->m_RegexEnd))
-					{
-						try
-						{
-							es.top()->m_EndHandler(*this, base_match);
-						}
-						catch (std::bad_function_call e)
-						{
-						}
-
-						es.pop();
-					}
-				}
+				ParseLine(*it, m_State);
 			}
 		}
 	};
@@ -0,0 +1,384 @@
+#include "auxParserBenchmark.h"
+#include "auxStaticParser.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <thread>
+
+namespace
+{
+	// Handlers count the groups they get; the counters are per chunk, so a parallel parse
+	// doesn't share them between threads.
+	class BenchmarkParser : public aux::StringParser
+	{
+	private:
+		struct alignas(64) Counter
+		{
+			uint64_t nCalls{ 0 };
+		};
+
+		mutable std::vector<Counter> m_Counters;
+		uint64_t                     m_nCalls{ 0 };
+
+	protected:
+		void OnParallelBegin(uint32_t nChunks) override
+		{
+			m_Counters.assign(nChunks, Counter());
+		}
+
+		void OnParallelEnd(uint32_t) override
+		{
+			for (auto& c : m_Counters)
+			{
+				m_nCalls += c.nCalls;
+			}
+
+			m_Counters.assign(1, Counter());
+		}
+
+	public:
+		BenchmarkParser() : m_Counters(1)
+		{
+		}
+
+		static bool Handler(const aux::StringParser& obj, const aux::ParserMatch& match)
+		{
+			const BenchmarkParser& parser = static_cast<const BenchmarkParser&>(obj);
+
+			parser.m_Counters[parser.GetChunk()].nCalls += match.size();
+
+			return true;
+		}
+
+		uint64_t GetCalls() const { return m_nCalls + m_Counters[0].nCalls; }
+
+		void Run(const std::vector<aux::ParserElement>& grammar, const std::vector<std::string>& file)
+		{
+			Init(grammar);
+			Parse(file.cbegin(), file.cend());
+		}
+
+		void Run(const std::vector<aux::ParserElement>& grammar, std::string_view text, bool bParallel, uint32_t nThreads = 0)
+		{
+			Init(grammar);
+			SetParallel(bParallel, nThreads);
+			ParseBuffer(text);
+		}
+	};
+
+	// Grammar of GenerateParserFile(), every pattern on the given engine.
+	std::vector<aux::ParserElement> MakeGrammar(uint32_t nTags, aux::ParserEngine engine)
+	{
+		auto handler = &BenchmarkParser::Handler;
+
+		auto matcher = [engine](const std::string& pattern)
+		{
+			return aux::MakeParserMatcher(pattern, false, engine);
+		};
+
+		std::vector<aux::ParserElement> grammar;
+
+		for (uint32_t t = 0; t < nTags; ++t)
+		{
+			std::string tag = "tag" + std::to_string(t);
+
+			grammar.emplace_back(matcher("\\s*<" + tag + ">\\s*"), handler, matcher("\\s*</" + tag + ">\\s*"), handler,
+				std::initializer_list<aux::ParserElement>{
+					aux::ParserElement(matcher("\\s*<value = ([\\d]+)>\\s*"), handler),
+					aux::ParserElement(matcher("\\s*<name = \"([^\"]*)\">\\s*"), handler),
+					aux::ParserElement(matcher("\\s*<flags = ((?:\\w+\\|)*\\w+)>\\s*"), handler)
+				});
+		}
+
+		return grammar;
+	}
+
+	// Startup benchmark: the <sphere>/<box> grammar of the demo, handlers count the lines.
+	struct SmallFileCounter
+	{
+		uint64_t nCalls{ 0 };
+	};
+
+	struct CountHandler
+	{
+		bool operator () (SmallFileCounter& counter, const aux::ParserMatch&) const
+		{
+			++counter.nCalls;
+
+			return true;
+		}
+	};
+
+	constexpr char SphereBegin[] = "<sphere>";
+	constexpr char SphereEnd[] = "</sphere>";
+	constexpr char BoxBegin[] = "<box>";
+	constexpr char BoxEnd[] = "</box>";
+	constexpr char Radius[] = "<radius = ([\\d]+)>";
+	constexpr char Size[] = "<size = ([\\d]+)>";
+
+	using StaticSceneParser = aux::StaticParser<SmallFileCounter,
+		aux::StaticGroup<SphereBegin, aux::ParserNoHandler, SphereEnd, aux::ParserNoHandler,
+			aux::StaticElement<Radius, CountHandler>>,
+		aux::StaticGroup<BoxBegin, aux::ParserNoHandler, BoxEnd, aux::ParserNoHandler,
+			aux::StaticElement<Size, CountHandler>>>;
+
+	class SceneParser : public aux::StringParser
+	{
+	public:
+		SmallFileCounter Counter;
+
+		SceneParser()
+		{
+			auto handler = [this](const aux::StringParser&, const aux::ParserMatch&)
+			{
+				++Counter.nCalls;
+
+				return true;
+			};
+
+			Init({
+				aux::ParserElement("<sphere>", nullptr, "</sphere>", nullptr,
+					{
+						aux::ParserElement("<radius = ([\\d]+)>", handler)
+					}),
+
+				aux::ParserElement("<box>", nullptr, "</box>", nullptr,
+					{
+						aux::ParserElement("<size = ([\\d]+)>", handler)
+					})
+				});
+		}
+	};
+}
+
+namespace aux
+{
+	std::vector<std::string> GenerateParserFile(const ParserBenchmarkSettings& settings)
+	{
+		std::mt19937 rnd(settings.nSeed);
+		std::vector<std::string> file;
+		const char* pFlags[] = { "read", "write", "stream", "loop", "cache" };
+
+		file.reserve(settings.nLines + 8);
+
+		while (file.size() < settings.nLines)
+		{
+			std::string tag = "tag" + std::to_string(rnd() % (settings.nTags ? settings.nTags : 1));
+			uint32_t nAttributes = 1 + rnd() % 6;
+
+			file.push_back("<" + tag + ">");
+
+			for (uint32_t i = 0; i < nAttributes; ++i)
+			{
+				switch (rnd() % 3)
+				{
+				case 0:
+					file.push_back("    <value = " + std::to_string(rnd() % 100000) + ">");
+					break;
+
+				case 1:
+					file.push_back("    <name = \"object_" + std::to_string(rnd() % 1000) + "\">");
+					break;
+
+				default:
+				{
+					std::string flags = pFlags[rnd() % 5];
+
+					for (uint32_t n = rnd() % 3; n; --n)
+					{
+						flags += std::string("|") + pFlags[rnd() % 5];
+					}
+
+					file.push_back("    <flags = " + flags + ">");
+					break;
+				}
+				}
+			}
+
+			file.push_back("</" + tag + ">");
+		}
+
+		return file;
+	}
+
+	void ParserBenchmark(std::ostream& os, const ParserBenchmarkSettings& settings)
+	{
+		std::vector<std::string> file = GenerateParserFile(settings);
+
+		// Same file as one buffer, the way a mapped file is parsed.
+		std::string text;
+
+		for (auto& s : file)
+		{
+			text += s;
+			text += "\r\n";
+		}
+
+		os << "lines: " << file.size() << ", tags: " << settings.nTags << std::endl;
+		os << std::left << std::setw(12) << "engine" << std::right << std::setw(12) << "seconds"
+			<< std::setw(16) << "lines/s" << std::setw(12) << "groups" << std::endl;
+
+		struct
+		{
+			const char*  pName;
+			ParserEngine Engine;
+			bool         bBuffer;
+			bool         bParallel;
+		}
+		engines[] = { { "regex", ParserEngine::Regex, false, false }, { "dfa", ParserEngine::Dfa, false, false },
+			{ "dfa/buffer", ParserEngine::Dfa, true, false }, { "dfa/threads", ParserEngine::Dfa, true, true } };
+
+		// dfa/buffer time, the base of the speedup below.
+		double dSerial = 0;
+
+		for (auto& e : engines)
+		{
+			BenchmarkParser parser;
+			std::vector<ParserElement> grammar = MakeGrammar(settings.nTags, e.Engine);
+
+			auto t0 = std::chrono::steady_clock::now();
+
+			if (e.bBuffer)
+			{
+				parser.Run(grammar, text, e.bParallel);
+			}
+			else
+			{
+				parser.Run(grammar, file);
+			}
+
+			auto t1 = std::chrono::steady_clock::now();
+			double seconds = std::chrono::duration<double>(t1 - t0).count();
+
+			os << std::left << std::setw(12) << e.pName << std::right << std::fixed << std::setprecision(3)
+				<< std::setw(12) << seconds << std::setprecision(0)
+				<< std::setw(16) << (file.size() / seconds) << std::setw(12) << parser.GetCalls() << std::endl;
+
+			if (!e.bParallel)
+			{
+				dSerial = seconds;
+			}
+		}
+
+		// Scaling of the parallel parse: 1, 2, 4, ... threads up to the number of cores.
+		const uint32_t nCores = std::max(1u, std::thread::hardware_concurrency());
+		std::vector<ParserElement> grammar = MakeGrammar(settings.nTags, ParserEngine::Dfa);
+
+		os << "cores: " << nCores << std::endl;
+		os << std::left << std::setw(12) << "threads" << std::right << std::setw(12) << "seconds"
+			<< std::setw(16) << "lines/s" << std::setw(12) << "speedup" << std::endl;
+
+		for (uint32_t nThreads = 1; ; nThreads = std::min(nThreads * 2, nCores))
+		{
+			BenchmarkParser parser;
+
+			auto t0 = std::chrono::steady_clock::now();
+
+			parser.Run(grammar, text, true, nThreads);
+
+			auto t1 = std::chrono::steady_clock::now();
+			double seconds = std::chrono::duration<double>(t1 - t0).count();
+
+			os << std::left << std::setw(12) << nThreads << std::right << std::fixed << std::setprecision(3)
+				<< std::setw(12) << seconds << std::setprecision(0) << std::setw(16) << (file.size() / seconds)
+				<< std::setprecision(2) << std::setw(12) << (dSerial / seconds) << std::endl;
+
+			if (nThreads == nCores)
+			{
+				break;
+			}
+		}
+	}
+
+	std::vector<std::string> GenerateSmallParserFiles(const ParserBenchmarkSettings& settings)
+	{
+		std::mt19937 rnd(settings.nSeed);
+		std::vector<std::string> files(settings.nSmallFiles);
+
+		for (auto& file : files)
+		{
+			for (uint32_t n = 1 + rnd() % 4; n; --n)
+			{
+				if (rnd() % 2)
+				{
+					file += "<sphere>\r\n<radius = " + std::to_string(rnd() % 1000) + ">\r\n</sphere>\r\n";
+				}
+				else
+				{
+					file += "<box>\r\n<size = " + std::to_string(rnd() % 1000) + ">\r\n</box>\r\n";
+				}
+			}
+		}
+
+		return files;
+	}
+
+	void ParserStartupBenchmark(std::ostream& os, const ParserBenchmarkSettings& settings)
+	{
+		std::vector<std::string> files = GenerateSmallParserFiles(settings);
+
+		os << "small files: " << files.size() << std::endl;
+		os << std::left << std::setw(16) << "parser" << std::right << std::setw(12) << "seconds"
+			<< std::setw(16) << "files/s" << std::setw(12) << "calls" << std::endl;
+
+		auto report = [&os, &files](const char* pName, std::chrono::steady_clock::time_point t0, uint64_t nCalls)
+		{
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+			os << std::left << std::setw(16) << pName << std::right << std::fixed << std::setprecision(3)
+				<< std::setw(12) << seconds << std::setprecision(0)
+				<< std::setw(16) << (files.size() / seconds) << std::setw(12) << nCalls << std::endl;
+		};
+
+		{
+			uint64_t nCalls = 0;
+			auto t0 = std::chrono::steady_clock::now();
+
+			for (auto& file : files)
+			{
+				SceneParser parser;
+
+				parser.ParseBuffer(file);
+				nCalls += parser.Counter.nCalls;
+			}
+
+			report("runtime/new", t0, nCalls);
+		}
+
+		{
+			SceneParser parser;
+			auto t0 = std::chrono::steady_clock::now();
+
+			for (auto& file : files)
+			{
+				parser.ParseBuffer(file);
+			}
+
+			report("runtime/shared", t0, parser.Counter.nCalls);
+		}
+
+		{
+			SmallFileCounter counter;
+			auto t0 = std::chrono::steady_clock::now();
+
+			for (auto& file : files)
+			{
+				StaticSceneParser parser;
+
+				parser.ParseBuffer(counter, file);
+			}
+
+			report("static/new", t0, counter.nCalls);
+		}
+	}
+
+	void ParserBenchmark(std::ostream& os)
+	{
+		ParserBenchmarkSettings settings;
+
+		ParserBenchmark(os, settings);
+		ParserStartupBenchmark(os, settings);
+	}
+}
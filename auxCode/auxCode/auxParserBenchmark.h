@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "auxParser.h"
+
+// Parser throughput: a generated configuration file with nTags group tags (every group holds
+// a few attribute lines) is parsed with the same grammar on every engine. Lines per second and
+// the number of handler calls (must be equal for all engines) are printed. The last runs parse
+// the same file as one text buffer (StringParser::ParseBuffer()), serially and in parallel; then
+// the parallel parse on 1, 2, 4, ... threads up to the number of cores, with the speedup over the
+// serial buffer parse.
+//
+// Startup: nSmallFiles small files of the <sphere>/<box> grammar, parsed by a StringParser created
+// for every file, by one StringParser for all of them and by a StaticParser created for every file.
+
+namespace aux
+{
+	struct ParserBenchmarkSettings
+	{
+		uint32_t nLines{ 100000 };  // approximate size of the file
+		uint32_t nTags{ 32 };       // number of different group tags
+		uint32_t nSeed{ 12345 };
+		uint32_t nSmallFiles{ 10000 };  // files of the startup benchmark
+	};
+
+	// Generated file: <tagN> ... </tagN> blocks with "value", "name" and "flags" lines.
+	std::vector<std::string> GenerateParserFile(const ParserBenchmarkSettings& settings);
+
+	// Generated small files: a few <sphere> and <box> groups each.
+	std::vector<std::string> GenerateSmallParserFiles(const ParserBenchmarkSettings& settings);
+
+	void ParserStartupBenchmark(std::ostream& os, const ParserBenchmarkSettings& settings);
+
+	void ParserBenchmark(std::ostream& os, const ParserBenchmarkSettings& settings);
+
+	void ParserBenchmark(std::ostream& os);
+}
@@ -0,0 +1,50 @@
+#include "auxParserMatcher.h"
+
+namespace aux
+{
+	ParserMatch::ParserMatch()
+	{
+	}
+
+	const std::csub_match& ParserMatch::operator[](size_t n) const
+	{
+		return (n < m_Groups.size()) ? m_Groups[n] : m_Unmatched;
+	}
+
+	RegexMatcher::RegexMatcher(const std::string& pattern, bool bCaseless)
+		: m_Regex(pattern, bCaseless ? (std::regex::ECMAScript | std::regex::icase) : std::regex::ECMAScript),
+		m_strPattern(pattern), m_bCaseless(bCaseless)
+	{
+	}
+
+	RegexMatcher::RegexMatcher(std::regex regex) : m_Regex(std::move(regex)), m_bCaseless(false)
+	{
+	}
+
+	bool RegexMatcher::Match(std::string_view s, ParserMatch& match) const
+	{
+		if (!std::regex_match(s.data(), s.data() + s.size(), match.m_RegexMatch, m_Regex))
+		{
+			return false;
+		}
+
+		match.m_Groups.assign(match.m_RegexMatch.begin(), match.m_RegexMatch.end());
+
+		return true;
+	}
+
+	std::shared_ptr<const ParserMatcher> MakeParserMatcher(const std::string& pattern, bool bCaseless, ParserEngine engine)
+	{
+		if (engine == ParserEngine::Dfa)
+		{
+			auto spMatcher = std::make_shared<DfaMatcher>(pattern, bCaseless);
+
+			if (spMatcher->IsValid())
+			{
+				return spMatcher;
+			}
+		}
+
+		return std::make_shared<RegexMatcher>(pattern, bCaseless);
+	}
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "auxDfaEngine.h"
+
+namespace aux
+{
+	// Result of a line match: group 0 is the whole line, 1..N are the capture groups.
+	// Interface follows std::match_results, so handlers read groups as match[1].str(); view()
+	// returns a group without a copy, it points into the parsed line and is valid in the handler.
+	class ParserMatch
+	{
+		friend class RegexMatcher;
+		friend class DfaMatcher;
+
+	private:
+		std::vector<std::csub_match> m_Groups;
+		std::csub_match              m_Unmatched;
+		std::cmatch                  m_RegexMatch;
+
+		// Working memory of the engines, kept between matches so a match doesn't allocate
+		// (after the first lines).
+		std::vector<size_t>          m_Scratch;
+
+	public:
+		ParserMatch();
+
+		size_t size() const { return m_Groups.size(); }
+
+		bool empty() const { return m_Groups.empty(); }
+
+		// Unmatched group for n >= size().
+		const std::csub_match& operator[](size_t n) const;
+
+		std::string str(size_t n = 0) const { return (*this)[n].str(); }
+
+		size_t length(size_t n = 0) const { return (*this)[n].length(); }
+
+		std::string_view view(size_t n = 0) const
+		{
+			const std::csub_match& g = (*this)[n];
+
+			return (g.matched) ? std::string_view(g.first, g.second - g.first) : std::string_view();
+		}
+	};
+
+	// Line matcher: decides whether the whole line matches a pattern.
+	class ParserMatcher
+	{
+	public:
+		virtual ~ParserMatcher() {}
+
+		// TRUE if the whole line matches, match receives the groups.
+		virtual bool Match(std::string_view s, ParserMatch& match) const = 0;
+
+		// Same answer as Match() when the groups are not needed; match is working memory only
+		// and holds no valid groups afterwards.
+		virtual bool Test(std::string_view s, ParserMatch& match) const { return Match(s, match); }
+
+		// Source text of the pattern ("" - unknown).
+		virtual const std::string& GetPattern() const = 0;
+
+		virtual bool IsCaseless() const = 0;
+	};
+
+	// std::regex engine: any ECMAScript pattern, backtracking.
+	class RegexMatcher : public ParserMatcher
+	{
+	private:
+		std::regex   m_Regex;
+		std::string  m_strPattern;
+		bool         m_bCaseless;
+
+	public:
+		RegexMatcher(const std::string& pattern, bool bCaseless = false);
+
+		// Pattern text is unknown, so the element takes no part in the prefix dispatch.
+		RegexMatcher(std::regex regex);
+
+		bool Match(std::string_view s, ParserMatch& match) const override;
+
+		const std::string& GetPattern() const override { return m_strPattern; }
+
+		bool IsCaseless() const override { return m_bCaseless; }
+	};
+
+	// DfaEngine (auxDfaEngine.h) over char: the subset of the syntax the grammars use, one table
+	// load per character, groups by a memoized backtracking pass after a successful match.
+	class DfaMatcher : public ParserMatcher
+	{
+	public:
+		static constexpr uint32_t MAX_STATES = DfaEngine<char>::MAX_STATES;
+
+	private:
+		std::string     m_strPattern;
+		bool            m_bCaseless;
+		DfaEngine<char> m_Engine;
+
+	public:
+		DfaMatcher(const std::string& pattern, bool bCaseless = false)
+			: m_strPattern(pattern), m_bCaseless(bCaseless), m_Engine(pattern, bCaseless)
+		{
+		}
+
+		// FALSE if the pattern uses syntax outside of the subset; Match() always fails then.
+		bool IsValid() const { return m_Engine.IsValid(); }
+
+		bool Match(std::string_view s, ParserMatch& match) const override
+		{
+			return m_Engine.Match(s, match.m_Scratch, match.m_Groups);
+		}
+
+		// Table pass only.
+		bool Test(std::string_view s, ParserMatch& match) const override
+		{
+			return m_Engine.Test(s, match.m_Scratch);
+		}
+
+		const std::string& GetPattern() const override { return m_strPattern; }
+
+		bool IsCaseless() const override { return m_bCaseless; }
+	};
+
+	enum class ParserEngine : int
+	{
+		Regex = 0,  // std::regex for every pattern
+		Dfa = 1     // DfaMatcher, std::regex for patterns outside of its subset
+	};
+
+	std::shared_ptr<const ParserMatcher> MakeParserMatcher(const std::string& pattern, bool bCaseless = false,
+		ParserEngine engine = ParserEngine::Dfa);
+}
@@ -0,0 +1,289 @@
+#include "auxPathBenchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <stack>
+
+namespace aux
+{
+	const char* GetPathMapName(PathMapType type)
+	{
+		switch (type)
+		{
+		    case PathMapType::Open:   return "open";
+		    case PathMapType::Random: return "random";
+		    case PathMapType::Maze:   return "maze";
+		    case PathMapType::Rooms:  return "rooms";
+		};
+
+		return "unknown";
+	}
+
+	bool GeneratePathMap(PathMatrix& pm, PathMapType type, unsigned int w, unsigned int h, unsigned int seed,
+		unsigned int density)
+	{
+		if ((!w) || (!h))
+			return false;
+
+		std::mt19937 rng{ seed };
+
+		//      (1 - )     .
+		std::vector<unsigned char> cells(static_cast<size_t>(w) * h, 0);
+
+		auto cell = [&cells, w](unsigned int x, unsigned int y) -> unsigned char&
+		{
+			return cells[static_cast<size_t>(y) * w + x];
+		};
+
+		switch (type)
+		{
+		    case PathMapType::Open:
+		    {
+				//  .
+			    break;
+		    }
+		    case PathMapType::Random:
+		    {
+				std::uniform_int_distribution<unsigned int> dist(0, 99);
+
+				for (auto &c : cells)
+				{
+					c = (dist(rng) < density) ? 1 : 0;
+				}
+
+			    break;
+		    }
+		    case PathMapType::Maze:
+		    {
+				//   - ,          
+				// (       ).
+				std::fill(cells.begin(), cells.end(), 1);
+
+				std::stack<PathPoint> st;
+				PathPoint start{ (w > 1) ? 1 : 0, (h > 1) ? 1 : 0 };
+
+				cell(start.first, start.second) = 0;
+				st.push(start);
+
+				while (!st.empty())
+				{
+					auto [x, y] = st.top();
+
+					//    ,     :
+					PathPoint next[4];
+					size_t nNext{ 0 };
+
+					if ((x >= 2) && (cell(x - 2, y)))        next[nNext++] = { x - 2, y };
+					if ((x + 2 < w) && (cell(x + 2, y)))     next[nNext++] = { x + 2, y };
+					if ((y >= 2) && (cell(x, y - 2)))        next[nNext++] = { x, y - 2 };
+					if ((y + 2 < h) && (cell(x, y + 2)))     next[nNext++] = { x, y + 2 };
+
+					if (!nNext)
+					{
+						//  -  .
+						st.pop();
+						continue;
+					}
+
+					auto [nx, ny] = next[std::uniform_int_distribution<size_t>(0, nNext - 1)(rng)];
+
+					//       :
+					cell((x + nx) / 2, (y + ny) / 2) = 0;
+					cell(nx, ny) = 0;
+
+					st.push({ nx, ny });
+				}
+
+			    break;
+		    }
+		    case PathMapType::Rooms:
+		    {
+				//  8x8 (7x7   + ),     -  .
+				const unsigned int room{ 8 };
+
+				for (unsigned int y = 0; y < h; y++)
+				{
+					for (unsigned int x = 0; x < w; x++)
+					{
+						if (((x % room) == room - 1) || ((y % room) == room - 1))
+						{
+							cell(x, y) = 1;
+						}
+					}
+				}
+
+				std::uniform_int_distribution<unsigned int> door(0, room - 2);
+
+				for (unsigned int y = 0; y < h; y += room)
+				{
+					for (unsigned int x = 0; x < w; x += room)
+					{
+						//       :
+						unsigned int dx{ x + room - 1 }, dy{ y + door(rng) };
+
+						if ((dx < w) && (dy < h))
+						{
+							cell(dx, dy) = 0;
+						}
+
+						dx = x + door(rng);
+						dy = y + room - 1;
+
+						if ((dx < w) && (dy < h))
+						{
+							cell(dx, dy) = 0;
+						}
+					}
+				}
+
+			    break;
+		    }
+		    default:
+		    {
+				return false;
+		    }
+		};
+
+		pm.Destroy(true);
+
+		if (!pm.Create(w, h))
+			return false;
+
+		return pm.Load(cells.data());
+	}
+
+	std::vector<PathSearchEngine> GetDefaultPathEngines()
+	{
+		return {
+			PathSearchEngine{ "bfs", [](PathMatrix& pm, const PathPoint s, const PathPoint d, std::list<PathPoint>& path, PathStats& stats)
+				{
+					return pm.FindPath(s, d, path, &stats);
+				} }
+		};
+	}
+
+	void PathBenchmark(std::ostream& os, const PathBenchmarkSettings& settings, const std::vector<PathSearchEngine>& engines)
+	{
+		using clock_type = std::chrono::steady_clock;
+
+		const PathMapType types[] = { PathMapType::Open, PathMapType::Random, PathMapType::Maze, PathMapType::Rooms };
+
+		//    :
+		auto percentile = [](const std::vector<double>& v, double p)
+		{
+			if (v.empty())
+				return 0.0;
+
+			size_t idx = static_cast<size_t>(p * (v.size() - 1) + 0.5);
+
+			return v[std::min(idx, v.size() - 1)];
+		};
+
+		os << std::left
+			<< std::setw(8) << "map" << std::setw(7) << "size" << std::setw(12) << "engine"
+			<< std::right
+			<< std::setw(8) << "found" << std::setw(12) << "expanded" << std::setw(12) << "peak KB"
+			<< std::setw(11) << "p50 us" << std::setw(11) << "p90 us" << std::setw(11) << "p99 us"
+			<< std::setw(11) << "max us" << std::setw(10) << "mismatch" << std::endl;
+
+		PathMatrix pm;
+
+		for (auto type : types)
+		{
+			for (auto size : settings.Sizes)
+			{
+				//       ,   :    .
+				unsigned int seed{ settings.nSeed ^ (static_cast<unsigned int>(type) << 24) ^ size };
+
+				if (!GeneratePathMap(pm, type, size, size, seed, settings.nDensity))
+					continue;
+
+				std::mt19937 rng{ seed };
+				std::uniform_int_distribution<unsigned int> coord(0, size - 1);
+
+				//    (    -  ):
+				auto random_free = [&]()
+				{
+					for (size_t attempt = 0; attempt < static_cast<size_t>(size) * size * 4; attempt++)
+					{
+						PathPoint p{ coord(rng), coord(rng) };
+						unsigned int bit;
+
+						if ((pm.GetBit(p.first, p.second, bit)) && (!bit))
+							return p;
+					}
+
+					return PathPoint{ 0, 0 };
+				};
+
+				std::vector<std::pair<PathPoint, PathPoint>> queries;
+
+				for (unsigned int q = 0; q < settings.nQueries; q++)
+				{
+					PathPoint s{ random_free() };
+					PathPoint d{ random_free() };
+
+					queries.emplace_back(s, d);
+				}
+
+				//      (0 -   ) -   .
+				std::vector<size_t> reference;
+
+				for (size_t e = 0; e < engines.size(); e++)
+				{
+					std::vector<double> latency;
+					size_t nFound{ 0 }, nExpanded{ 0 }, nPeakBytes{ 0 }, nMismatch{ 0 };
+
+					for (size_t q = 0; q < queries.size(); q++)
+					{
+						std::list<PathPoint> path;
+						PathStats stats;
+
+						auto t0 = clock_type::now();
+						bool found = engines[e].Search(pm, queries[q].first, queries[q].second, path, stats);
+						auto t1 = clock_type::now();
+
+						latency.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+
+						size_t length{ found ? path.size() : 0 };
+
+						if (e == 0)
+						{
+							reference.push_back(length);
+						}
+						else
+						if (reference[q] != length)
+						{
+							nMismatch++;
+						}
+
+						nFound += (found ? 1 : 0);
+						nExpanded += stats.nExpanded;
+						nPeakBytes = std::max(nPeakBytes, stats.nPeakBytes);
+					}
+
+					std::sort(latency.begin(), latency.end());
+
+					os << std::left
+						<< std::setw(8) << GetPathMapName(type) << std::setw(7) << size << std::setw(12) << engines[e].Name
+						<< std::right
+						<< std::setw(8) << nFound
+						<< std::setw(12) << (queries.empty() ? 0 : nExpanded / queries.size())
+						<< std::setw(12) << (nPeakBytes / 1024)
+						<< std::fixed << std::setprecision(1)
+						<< std::setw(11) << percentile(latency, 0.50)
+						<< std::setw(11) << percentile(latency, 0.90)
+						<< std::setw(11) << percentile(latency, 0.99)
+						<< std::setw(11) << (latency.empty() ? 0.0 : latency.back())
+						<< std::setw(10) << nMismatch << std::endl;
+				}
+			}
+		}
+	}
+
+	void PathBenchmark(std::ostream& os)
+	{
+		PathBenchmark(os, PathBenchmarkSettings(), GetDefaultPathEngines());
+	}
+}
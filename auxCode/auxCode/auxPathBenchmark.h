@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <list>
+#include <string>
+#include <functional>
+#include <iostream>
+#include "auxPathMatrix.h"
+
+/*
+
+   :    (,  , ,  )
+          .   
+  :   ,      .
+
+                .
+
+*/
+
+namespace aux
+{
+	//   :
+	enum class PathMapType : int
+	{
+		Open = 0,   //    
+		Random = 1, //  
+		Maze = 2,   //  (    )
+		Rooms = 3   //   
+	};
+
+	using PathPoint = std::pair<unsigned int, unsigned int>;
+
+	//  :     (, , , , ).
+	struct PathSearchEngine
+	{
+		std::string Name;
+		std::function<bool(PathMatrix&, const PathPoint, const PathPoint, std::list<PathPoint>&, PathStats&)> Search;
+	};
+
+	//  :
+	struct PathBenchmarkSettings
+	{
+		std::vector<unsigned int> Sizes{ 32, 64, 128, 256 }; //   
+		unsigned int              nQueries{ 32 };            //    
+		unsigned int              nSeed{ 12345 };            //   (   )
+		unsigned int              nDensity{ 30 };            //    PathMapType::Random
+	};
+
+	//    :
+	const char* GetPathMapName(PathMapType type);
+
+	//    .     (  ).
+	bool GeneratePathMap(PathMatrix& pm, PathMapType type, unsigned int w, unsigned int h, unsigned int seed,
+		unsigned int density = 30);
+
+	//    ( - PathMatrix::FindPath,   ).
+	std::vector<PathSearchEngine> GetDefaultPathEngines();
+
+	//         .
+	void PathBenchmark(std::ostream& os, const PathBenchmarkSettings& settings, const std::vector<PathSearchEngine>& engines);
+
+	//       .
+	void PathBenchmark(std::ostream& os);
+}
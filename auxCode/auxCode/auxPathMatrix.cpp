@@ -1,8 +1,85 @@
 #include "auxPathMatrix.h"
 #include <algorithm>
+#include <cstring>
+#include <utility>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || defined(__SSE2__)
+#include <emmintrin.h>
+#define AUX_PATHMATRIX_SSE2
+#endif
 
 namespace aux
 {
+	namespace
+	{
+		//  nCount  (0 /  0)  .  (nCount + 31) / 32 ,    - .
+		void PackBytes(const unsigned char* pSrc, size_t nCount, unsigned int* pDst)
+		{
+			size_t i{ 0 };
+
+#ifdef AUX_PATHMATRIX_SSE2
+			const __m128i zero = _mm_setzero_si128();
+
+			//  32   :        .
+			for (; i + 32 <= nCount; i += 32)
+			{
+				__m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+				__m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i + 16));
+
+				unsigned int zlo = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(lo, zero)));
+				unsigned int zhi = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(hi, zero)));
+
+				*pDst++ = ~(zlo | (zhi << 16));
+			}
+#endif
+
+			//  (    SSE2):
+			for (; i < nCount; i += 32)
+			{
+				size_t n = std::min<size_t>(32, nCount - i);
+				unsigned int word{ 0 };
+
+				for (size_t k = 0; k < n; ++k)
+				{
+					word |= ((unsigned int)(pSrc[i + k] ? 1 : 0) << k);
+				}
+
+				*pDst++ = word;
+			}
+		}
+
+		//  nCount      0/1.
+		void UnpackBits(const unsigned int* pSrc, size_t nCount, unsigned char* pDst)
+		{
+			size_t i{ 0 };
+
+#ifdef AUX_PATHMATRIX_SSE2
+			const __m128i select = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+			const __m128i one = _mm_set1_epi8(1);
+
+			//  16   :      8  ,  -   8.
+			for (; i + 16 <= nCount; i += 16)
+			{
+				unsigned int bits = (pSrc[i / 32] >> (i % 32)) & 0xFFFF;
+
+				__m128i v = _mm_cvtsi32_si128(static_cast<int>(bits));
+				v = _mm_unpacklo_epi8(v, v);
+				v = _mm_unpacklo_epi16(v, v);
+				v = _mm_unpacklo_epi32(v, v);
+
+				v = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(v, select), select), one);
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), v);
+			}
+#endif
+
+			for (; i < nCount; ++i)
+			{
+				pDst[i] = static_cast<unsigned char>((pSrc[i / 32] >> (i % 32)) & 1);
+			}
+		}
+	}
+
 	PathMatrix::PathMatrix()
 	{
 		m_Width = m_Height = 0;
@@ -18,6 +95,44 @@ namespace aux
 		m_Data = obj.m_Data;
 	}
 
+	PathMatrix::PathMatrix(PathMatrix&& obj) noexcept
+	{
+		m_Width = std::exchange(obj.m_Width, 0);
+		m_Height = std::exchange(obj.m_Height, 0);
+		m_LineBytes = std::exchange(obj.m_LineBytes, 0);
+
+		m_Data = std::move(obj.m_Data);
+	}
+
+	PathMatrix& PathMatrix::operator = (const PathMatrix& obj)
+	{
+		if (this != &obj)
+		{
+			m_Width = obj.m_Width;
+			m_Height = obj.m_Height;
+			m_LineBytes = obj.m_LineBytes;
+
+			//     ,   :
+			m_Data = obj.m_Data;
+		}
+
+		return *this;
+	}
+
+	PathMatrix& PathMatrix::operator = (PathMatrix&& obj) noexcept
+	{
+		if (this != &obj)
+		{
+			m_Width = std::exchange(obj.m_Width, 0);
+			m_Height = std::exchange(obj.m_Height, 0);
+			m_LineBytes = std::exchange(obj.m_LineBytes, 0);
+
+			m_Data = std::move(obj.m_Data);
+		}
+
+		return *this;
+	}
+
 	bool PathMatrix::IsEmpty()
 	{
 		return !((m_Width) && (m_Height));
@@ -53,7 +168,9 @@ namespace aux
 
 		//           (  ):
 		m_LineBytes = (alignedw / 8);
-		m_Data.resize(m_LineBytes * h, 0);
+
+		//   -  . assign()   ,  Destroy(true):
+		m_Data.assign(static_cast<size_t>(m_LineBytes / 4) * h, 0);
 
 		return true;
 	}
@@ -66,24 +183,12 @@ namespace aux
 		if (!Create(w, h))
 			return false;
 
-		//   -, -.
-		unsigned int cur_x{ 0 }, cur_y{ 0 };
-		for (auto &e : data)
-		{
-			SetBit(cur_x, cur_y, (e ? 1 : 0));
-
-			if (++cur_x >= w)
-			{
-				cur_x = 0;
-				cur_y++;
-			};
-		}
-
-		return true;
+		//   -, - -  .
+		return Load(reinterpret_cast<const unsigned char*>(data.begin()));
 	}
 
 
-	bool PathMatrix::Destroy()
+	bool PathMatrix::Destroy(bool keepmemory)
 	{
 		if (!IsEmpty())
 		{
@@ -92,7 +197,11 @@ namespace aux
 			m_LineBytes = 0;
 
 			m_Data.clear();
-			m_Data.shrink_to_fit();
+
+			if (!keepmemory)
+			{
+				m_Data.shrink_to_fit();
+			}
 
 			return true;
 		};
@@ -165,28 +274,121 @@ namespace aux
 		return true;
 	}
 
+	bool PathMatrix::LoadRow(const unsigned int y, const unsigned char* pBytes)
+	{
+		if ((y >= m_Height) || (IsEmpty()) || (!pBytes))
+			return false;
+
+		PackBytes(pBytes, m_Width, &m_Data[static_cast<size_t>(y) * GetLineWords()]);
+
+		return true;
+	}
+
+	bool PathMatrix::LoadRowBits(const unsigned int y, const unsigned int* pBits)
+	{
+		if ((y >= m_Height) || (IsEmpty()) || (!pBits))
+			return false;
+
+		unsigned int words{ GetLineWords() };
+		unsigned int* pLine = &m_Data[static_cast<size_t>(y) * words];
+
+		std::memcpy(pLine, pBits, words * sizeof(unsigned int));
+
+		//     ()   :
+		if (unsigned int tail{ m_Width % 32 }; tail)
+		{
+			pLine[words - 1] &= (((unsigned int)1 << tail) - 1);
+		}
+
+		return true;
+	}
+
+	bool PathMatrix::Load(const unsigned char* pBytes, size_t nPitch)
+	{
+		if ((IsEmpty()) || (!pBytes))
+			return false;
+
+		if (!nPitch)
+		{
+			nPitch = m_Width;
+		}
+
+		unsigned int words{ GetLineWords() };
+
+		for (unsigned int y = 0; y < m_Height; y++)
+		{
+			PackBytes(pBytes + y * nPitch, m_Width, &m_Data[static_cast<size_t>(y) * words]);
+		}
+
+		return true;
+	}
+
+	bool PathMatrix::StoreRow(const unsigned int y, unsigned char* pBytes)
+	{
+		if ((y >= m_Height) || (IsEmpty()) || (!pBytes))
+			return false;
+
+		UnpackBits(&m_Data[static_cast<size_t>(y) * GetLineWords()], m_Width, pBytes);
+
+		return true;
+	}
+
+	bool PathMatrix::StoreRowBits(const unsigned int y, unsigned int* pBits)
+	{
+		if ((y >= m_Height) || (IsEmpty()) || (!pBits))
+			return false;
+
+		unsigned int words{ GetLineWords() };
+
+		std::memcpy(pBits, &m_Data[static_cast<size_t>(y) * words], words * sizeof(unsigned int));
+
+		return true;
+	}
+
+	bool PathMatrix::Store(unsigned char* pBytes, size_t nPitch)
+	{
+		if ((IsEmpty()) || (!pBytes))
+			return false;
+
+		if (!nPitch)
+		{
+			nPitch = m_Width;
+		}
+
+		unsigned int words{ GetLineWords() };
+
+		for (unsigned int y = 0; y < m_Height; y++)
+		{
+			UnpackBits(&m_Data[static_cast<size_t>(y) * words], m_Width, pBytes + y * nPitch);
+		}
+
+		return true;
+	}
+
 	void PathMatrix::Dump(std::ostream &os)
 	{
 		if (IsEmpty())
 			return;
 
-		unsigned int bit;
+		//       :
+		std::vector<unsigned char> line(m_Width);
 
 		for (unsigned int y = 0; y < m_Height; y++)
 		{
-			for (unsigned int x = 0; x < m_Width; x++)
-			{
-				GetBitFast(x, y, bit);
+			StoreRow(y, line.data());
 
-				os << (bit ? '1' : '0');
+			for (auto &c : line)
+			{
+				c += '0';
 			}
 
+			os.write(reinterpret_cast<const char*>(line.data()), line.size());
 			os << std::endl;
 		}
 	}
 
 	bool PathMatrix::FindPath(const std::pair<unsigned int, unsigned int> s, const std::pair<unsigned int, unsigned int> d,
-		std::list<std::pair<unsigned int, unsigned int>>& lpath)
+		std::list<std::pair<unsigned int, unsigned int>>& lpath, PathStats* pStats)
 	{
 		using step_type = std::pair<unsigned int, unsigned int>;
 		using path_type = std::list<step_type>;
@@ -204,10 +406,35 @@ namespace aux
 		path_type cur_path{ s };
 		step_type last_step, next_step;
 
+		//   :  ,      (  ).
+		size_t nExpanded{ 0 }, nSteps{ 0 }, nPeakSteps{ 0 }, nPaths{ 0 }, nPeakPaths{ 0 };
+
+		auto UpdatePeak = [&]()
+		{
+			nPeakSteps = std::max(nPeakSteps, nSteps);
+			nPeakPaths = std::max(nPeakPaths, nPaths);
+		};
+
+		auto StoreStats = [&]()
+		{
+			if (pStats)
+			{
+				//  :  +  .   .
+				pStats->nExpanded = nExpanded;
+				pStats->nPeakSteps = nPeakSteps;
+				pStats->nPeakBytes = nPeakSteps * (sizeof(step_type) + 2 * sizeof(void*)) +
+					nPeakPaths * (sizeof(path_type) + 2 * sizeof(void*)) +
+					mtx.m_Data.size() * sizeof(unsigned int);
+			}
+		};
+
 		//    .
 		vl.push_back(cur_path);
+		nSteps = 1;
+		nPaths = 1;
+		UpdatePeak();
 
-		auto CheckStep = [&mtx, &cur_path, &vl, &last_step, &next_step](unsigned int x, unsigned int y)
+		auto CheckStep = [&mtx, &cur_path, &vl, &last_step, &next_step, &nSteps, &nPaths, &UpdatePeak](unsigned int x, unsigned int y)
 		{
 			if (unsigned int bit{ 1 }; mtx.GetBit(x, y, bit))
 			{
@@ -222,6 +449,10 @@ namespace aux
 					cur_path.push_back(next_step);
 					vl.push_back(cur_path);
 
+					nSteps += cur_path.size();
+					nPaths++;
+					UpdatePeak();
+
 					//       (  ).
 					cur_path.pop_back();
 				}
@@ -234,6 +465,10 @@ namespace aux
 			cur_path = vl.front();
 			vl.pop_front();
 
+			nSteps -= cur_path.size();
+			nPaths--;
+			nExpanded++;
+
 			// ,    :
 			last_step = cur_path.back();
 			if (last_step == d)
@@ -241,6 +476,8 @@ namespace aux
 				// ,     .
 				lpath = cur_path;
 
+				StoreStats();
+
 				return true;
 			};
 
@@ -253,6 +490,8 @@ namespace aux
 
 		} while (vl.size()); //    
 
+		StoreStats();
+
 		return false;
 	}
 
@@ -19,6 +19,14 @@
 
 namespace aux
 {
+	//    ( FindPath(),   ):
+	struct PathStats
+	{
+		size_t nExpanded{ 0 };  //   
+		size_t nPeakSteps{ 0 }; //   ,    
+		size_t nPeakBytes{ 0 }; //      ( )
+	};
+
 	class PathMatrix
 	{
 	public:
@@ -32,6 +40,10 @@ namespace aux
 	public:
 		PathMatrix();
 		PathMatrix(const PathMatrix& obj);
+		PathMatrix(PathMatrix&& obj) noexcept;
+
+		PathMatrix& operator = (const PathMatrix& obj);
+		PathMatrix& operator = (PathMatrix&& obj) noexcept;
 
 		//  TRUE,    :
 		bool IsEmpty();
@@ -42,8 +54,9 @@ namespace aux
 		//          . 
 		bool Create(const unsigned int w, const unsigned int h, std::initializer_list<char> data);
 
-		//  ,   :
-		bool Destroy();
+		//  ,   .  keepmemory == true,   
+		//      Create():
+		bool Destroy(bool keepmemory = false);
 
 		//     :
 		bool Clear();
@@ -56,10 +69,32 @@ namespace aux
 		bool GetBit(const unsigned int x, const unsigned int y, unsigned int& b);
 		bool GetBitFast(const unsigned int x, const unsigned int y, unsigned int& b);
 
+		//  : w   ,    -  .
+		bool LoadRow(const unsigned int y, const unsigned char* pBytes);
+
+		//      (    ,   - x = 0):
+		bool LoadRowBits(const unsigned int y, const unsigned int* pBits);
+
+		//       (nPitch -     , 0 = w):
+		bool Load(const unsigned char* pBytes, size_t nPitch = 0);
+
+		//  : w    0/1.
+		bool StoreRow(const unsigned int y, unsigned char* pBytes);
+
+		//     (GetLineWords()   ):
+		bool StoreRowBits(const unsigned int y, unsigned int* pBits);
+
+		//       (nPitch -     , 0 = w):
+		bool Store(unsigned char* pBytes, size_t nPitch = 0);
+
+		//  32-    :
+		unsigned int GetLineWords() const { return m_LineBytes / 4; }
+
 		void Dump(std::ostream &os);
 
 		//        (sx, sy) -> (dx, dy).
+		//  pStats != nullptr -    .
 		bool FindPath(const std::pair<unsigned int, unsigned int> s, const std::pair<unsigned int, unsigned int> d,
-			std::list<std::pair<unsigned int, unsigned int>>& lpath);
+			std::list<std::pair<unsigned int, unsigned int>>& lpath, PathStats* pStats = nullptr);
 	};
 }
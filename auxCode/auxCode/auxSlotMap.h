@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include <type_traits>
+
+// Slot map: dense storage of values addressed by generational handles.
+//
+// A handle packs a slot index (low INDEX_BITS bits) and the generation of that slot (high bits)
+// into one TKey word (uint32_t or uint64_t). Values live contiguously in a dense array, so
+// iteration is a plain array walk. Insert, Erase and Find are O(1): Find is one load from the
+// slot array plus the value access, Erase moves the last value into the hole.
+//
+// Like auxKeyGenerator in generational mode, an issued handle always has an odd generation and a
+// free slot holds an even one, so a handle of an erased value never matches again (until the
+// generation counter wraps).
+
+template <typename T, typename TKey = uint32_t, unsigned INDEX_BITS = sizeof(TKey) * 4>
+class auxSlotMap
+{
+	static_assert(std::is_unsigned<TKey>::value, "auxSlotMap: key type must be unsigned");
+	static_assert((INDEX_BITS > 0) && (INDEX_BITS + 2 <= sizeof(TKey) * 8), "auxSlotMap: invalid number of index bits");
+
+public:
+	using key_type = TKey;
+
+	static constexpr TKey INDEX_MASK = (TKey(1) << INDEX_BITS) - 1;
+	static constexpr TKey GENERATION_MASK = TKey(~TKey(0)) >> INDEX_BITS;
+	static constexpr uint32_t NO_SLOT = 0xFFFFFFFF;
+
+private:
+	struct Slot
+	{
+		TKey     Key;    // current handle of the slot (even generation = free)
+		uint32_t nNext;  // issued: position in the dense array; free: next free slot
+	};
+
+	std::vector<Slot>     m_vecSlots;
+	std::vector<T>        m_vecValues;     // dense values
+	std::vector<uint32_t> m_vecValueSlot;  // dense position -> slot index
+	uint32_t              m_nFreeHead{ NO_SLOT };
+
+public:
+	auxSlotMap()
+	{
+	}
+
+	// Inserts a value and returns its handle.
+	template <typename ... TS>
+	TKey Emplace(TS&& ... args)
+	{
+		// Table is full when the next index doesn't fit into the handle.
+		if ((m_nFreeHead == NO_SLOT) && (m_vecSlots.size() >= INDEX_MASK))
+		{
+			return 0;
+		}
+
+		// Value first: if its constructor throws, the table is unchanged.
+		m_vecValues.emplace_back(std::forward<TS>(args)...);
+
+		uint32_t index;
+
+		if (m_nFreeHead != NO_SLOT)
+		{
+			index = m_nFreeHead;
+			m_nFreeHead = m_vecSlots[index].nNext;
+		}
+		else
+		{
+			index = static_cast<uint32_t>(m_vecSlots.size());
+			m_vecSlots.push_back(Slot{ static_cast<TKey>(index), NO_SLOT });
+		}
+
+		m_vecValueSlot.push_back(index);
+
+		Slot& slot = m_vecSlots[index];
+
+		slot.Key = MakeKey(index, NextGeneration(slot.Key));
+		slot.nNext = static_cast<uint32_t>(m_vecValues.size() - 1);
+
+		return slot.Key;
+	}
+
+	TKey Insert(const T& value)
+	{
+		return Emplace(value);
+	}
+
+	TKey Insert(T&& value)
+	{
+		return Emplace(std::move(value));
+	}
+
+	// Removes the value, returns false for stale or invalid handles.
+	bool Erase(TKey key)
+	{
+		if (!Contains(key))
+		{
+			return false;
+		}
+
+		uint32_t index = static_cast<uint32_t>(key & INDEX_MASK);
+		Slot& slot = m_vecSlots[index];
+		uint32_t nPos = slot.nNext;
+		uint32_t nLast = static_cast<uint32_t>(m_vecValues.size() - 1);
+
+		// Last value fills the hole.
+		if (nPos != nLast)
+		{
+			m_vecValues[nPos] = std::move(m_vecValues[nLast]);
+			m_vecValueSlot[nPos] = m_vecValueSlot[nLast];
+			m_vecSlots[m_vecValueSlot[nPos]].nNext = nPos;
+		}
+
+		m_vecValues.pop_back();
+		m_vecValueSlot.pop_back();
+
+		// Even generation: the slot is free and the old handle no longer matches.
+		slot.Key = MakeKey(index, NextGeneration(key));
+		slot.nNext = m_nFreeHead;
+		m_nFreeHead = index;
+
+		return true;
+	}
+
+	// TRUE if the handle refers to a live value.
+	bool Contains(TKey key) const
+	{
+		TKey index = key & INDEX_MASK;
+
+		return (index < m_vecSlots.size()) && (m_vecSlots[static_cast<size_t>(index)].Key == key) && ((key >> INDEX_BITS) & 1);
+	}
+
+	// Returns nullptr for stale or invalid handles.
+	T* Find(TKey key)
+	{
+		return Contains(key) ? &m_vecValues[m_vecSlots[static_cast<size_t>(key & INDEX_MASK)].nNext] : nullptr;
+	}
+
+	const T* Find(TKey key) const
+	{
+		return Contains(key) ? &m_vecValues[m_vecSlots[static_cast<size_t>(key & INDEX_MASK)].nNext] : nullptr;
+	}
+
+	void Clear()
+	{
+		// Every issued handle is invalidated, slots go to the free list.
+		for (uint32_t index : m_vecValueSlot)
+		{
+			Slot& slot = m_vecSlots[index];
+
+			slot.Key = MakeKey(index, NextGeneration(slot.Key));
+			slot.nNext = m_nFreeHead;
+			m_nFreeHead = index;
+		}
+
+		m_vecValues.clear();
+		m_vecValueSlot.clear();
+	}
+
+	void Reserve(size_t nCount)
+	{
+		m_vecSlots.reserve(nCount);
+		m_vecValues.reserve(nCount);
+		m_vecValueSlot.reserve(nCount);
+	}
+
+	size_t Size() const { return m_vecValues.size(); }
+
+	bool IsEmpty() const { return m_vecValues.empty(); }
+
+	// Handle of the value at dense position nPos (for iteration together with begin()/end()).
+	TKey KeyAt(size_t nPos) const { return m_vecSlots[m_vecValueSlot[nPos]].Key; }
+
+	// Dense iteration over the values (order changes on Erase).
+	typename std::vector<T>::iterator begin() { return m_vecValues.begin(); }
+	typename std::vector<T>::iterator end() { return m_vecValues.end(); }
+	typename std::vector<T>::const_iterator begin() const { return m_vecValues.cbegin(); }
+	typename std::vector<T>::const_iterator end() const { return m_vecValues.cend(); }
+
+private:
+	static TKey NextGeneration(TKey key)
+	{
+		return ((key >> INDEX_BITS) + 1) & GENERATION_MASK;
+	}
+
+	static TKey MakeKey(uint32_t index, TKey generation)
+	{
+		return (generation << INDEX_BITS) | static_cast<TKey>(index);
+	}
+};
@@ -0,0 +1,297 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "auxMappedFile.h"
+#include "auxParser.h"
+#include "auxParserMatcher.h"
+
+// Grammar declared at compile time: elements are template parameters, handlers are function
+// object types called directly (no std::function), patterns are constexpr character arrays.
+//
+//	constexpr char SphereBegin[] = "<sphere>";
+//	constexpr char SphereEnd[] = "</sphere>";
+//	constexpr char Radius[] = "<radius = ([\\d]+)>";
+//
+//	struct RadiusHandler
+//	{
+//		bool operator () (Scene& scene, const aux::ParserMatch& match) const { ... }
+//	};
+//
+//	using SceneParser = aux::StaticParser<Scene,
+//		aux::StaticGroup<SphereBegin, aux::ParserNoHandler, SphereEnd, aux::ParserNoHandler,
+//			aux::StaticElement<Radius, RadiusHandler>>>;
+//
+//	SceneParser().ParseBuffer(scene, text);
+//
+// Handlers get the context object passed to Parse() and the groups of the line. The literal prefix
+// of every pattern is found at compile time and tested before the matcher. Matchers (DfaMatcher,
+// std::regex outside of its subset) are built once per pattern on the first use and shared by all
+// parsers of the program, so a parser costs nothing to create and allocates nothing per file except
+// the group memory of its first lines. Patterns are case sensitive.
+
+namespace aux
+{
+	struct ParserNoHandler
+	{
+		template <typename Context>
+		bool operator () (Context&, const ParserMatch&) const
+		{
+			return true;
+		}
+	};
+
+	// Literal prefix of a pattern, by the rules of the run-time dispatch (StringParser):
+	// stops at the first construct that is not a fixed character, empty for patterns with '|'.
+	// Longer prefixes are cut to the first MAX_LENGTH characters.
+	struct StaticPrefix
+	{
+		static constexpr size_t MAX_LENGTH = 32;
+
+		char   Text[MAX_LENGTH];
+		size_t nLength;
+	};
+
+	constexpr bool IsStaticPatternChar(char c, const char* pSet)
+	{
+		for (; *pSet; ++pSet)
+		{
+			if (*pSet == c)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	constexpr StaticPrefix GetStaticPrefix(const char* pPattern)
+	{
+		StaticPrefix prefix{};
+		size_t nSize = 0;
+		bool bClass = false;
+
+		while (pPattern[nSize])
+		{
+			++nSize;
+		}
+
+		for (size_t i = 0; i < nSize; ++i)
+		{
+			if (pPattern[i] == '\\')
+			{
+				++i;
+			}
+			else if (pPattern[i] == '[')
+			{
+				bClass = true;
+			}
+			else if (pPattern[i] == ']')
+			{
+				bClass = false;
+			}
+			else if ((pPattern[i] == '|') && (!bClass))
+			{
+				return prefix;
+			}
+		}
+
+		size_t i = ((nSize) && (pPattern[0] == '^')) ? 1 : 0;
+
+		while ((i < nSize) && (prefix.nLength < StaticPrefix::MAX_LENGTH))
+		{
+			char c = pPattern[i];
+			size_t next = i + 1;
+
+			if (c == '\\')
+			{
+				// \d, \w, \b, \1, ... are not literals.
+				if ((next >= nSize) || (((pPattern[next] >= '0') && (pPattern[next] <= '9')) ||
+					((pPattern[next] >= 'a') && (pPattern[next] <= 'z')) || ((pPattern[next] >= 'A') && (pPattern[next] <= 'Z'))))
+				{
+					break;
+				}
+
+				c = pPattern[next++];
+			}
+			else if (IsStaticPatternChar(c, ".[]{}()*+?|^$\\"))
+			{
+				break;
+			}
+
+			// Quantified character may be missing (or repeated) in the line.
+			if ((next < nSize) && (IsStaticPatternChar(pPattern[next], "*+?{")))
+			{
+				break;
+			}
+
+			prefix.Text[prefix.nLength++] = c;
+			i = next;
+		}
+
+		return prefix;
+	}
+
+	// One pattern of the grammar: its prefix and its shared matcher.
+	template <const char* Pattern>
+	struct StaticPattern
+	{
+		static constexpr StaticPrefix Prefix = GetStaticPrefix(Pattern);
+
+		static const ParserMatcher& GetMatcher()
+		{
+			static const std::shared_ptr<const ParserMatcher> spMatcher = MakeParserMatcher(Pattern);
+
+			return *spMatcher;
+		}
+
+		static bool Match(std::string_view s, ParserMatch& match)
+		{
+			if ((s.size() < Prefix.nLength) || (s.compare(0, Prefix.nLength, std::string_view(Prefix.Text, Prefix.nLength))))
+			{
+				return false;
+			}
+
+			return GetMatcher().Match(s, match);
+		}
+	};
+
+	// Position of a pass in the grammar: the stack holds the line function of every open group.
+	template <typename Context>
+	struct StaticParserState
+	{
+		using LineFunction = void (*)(Context&, std::string_view, StaticParserState&);
+
+		LineFunction* pStack;
+		size_t        nTop;
+		ParserMatch   Match;
+	};
+
+	template <const char* Pattern, typename Handler = ParserNoHandler>
+	struct StaticElement
+	{
+		static constexpr size_t DEPTH = 0;
+
+		template <typename Context>
+		static bool Begin(Context& ctx, std::string_view s, StaticParserState<Context>& state)
+		{
+			if (!StaticPattern<Pattern>::Match(s, state.Match))
+			{
+				return false;
+			}
+
+			Handler()(ctx, state.Match);
+
+			return true;
+		}
+	};
+
+	template <const char* BeginPattern, typename BeginHandler, const char* EndPattern, typename EndHandler,
+		typename... Children>
+	struct StaticGroup
+	{
+		static constexpr size_t DEPTH = 1 + std::max({ size_t(0), Children::DEPTH... });
+
+		template <typename Context>
+		static bool Begin(Context& ctx, std::string_view s, StaticParserState<Context>& state)
+		{
+			if (!StaticPattern<BeginPattern>::Match(s, state.Match))
+			{
+				return false;
+			}
+
+			BeginHandler()(ctx, state.Match);
+
+			state.pStack[++state.nTop] = &Line<Context>;
+
+			return true;
+		}
+
+		// Line inside the group: the first child that matches, otherwise the end of the group.
+		template <typename Context>
+		static void Line(Context& ctx, std::string_view s, StaticParserState<Context>& state)
+		{
+			if ((Children::template Begin<Context>(ctx, s, state) || ...))
+			{
+				return;
+			}
+
+			if (StaticPattern<EndPattern>::Match(s, state.Match))
+			{
+				EndHandler()(ctx, state.Match);
+
+				--state.nTop;
+			}
+		}
+	};
+
+	template <typename Context, typename... Elements>
+	class StaticParser
+	{
+	public:
+		// Deepest nesting of groups, the size of the element stack.
+		static constexpr size_t DEPTH = std::max({ size_t(0), Elements::DEPTH... });
+
+	private:
+		using State = StaticParserState<Context>;
+
+		std::array<typename State::LineFunction, DEPTH + 1> m_Stack;
+		State                                               m_State;
+
+		static void RootLine(Context& ctx, std::string_view s, State& state)
+		{
+			(Elements::template Begin<Context>(ctx, s, state) || ...);
+		}
+
+	public:
+		StaticParser()
+		{
+			m_Stack[0] = &RootLine;
+
+			m_State.pStack = m_Stack.data();
+			m_State.nTop = 0;
+		}
+
+		// The state points into the parser.
+		StaticParser(const StaticParser&) = delete;
+
+		StaticParser& operator = (const StaticParser&) = delete;
+
+		// Lines are anything std::string_view is constructible from; the line is not copied.
+		template <typename IT>
+		void Parse(Context& ctx, IT itbegin, IT itend)
+		{
+			m_State.nTop = 0;
+
+			for (IT it = itbegin; it != itend; ++it)
+			{
+				m_Stack[m_State.nTop](ctx, *it, m_State);
+			}
+		}
+
+		void ParseBuffer(Context& ctx, std::string_view text)
+		{
+			Parse(ctx, ParserLineIterator(text), ParserLineIterator());
+		}
+
+		// FALSE if the file can't be opened or mapped.
+		bool ParseFile(Context& ctx, const std::string& fileName)
+		{
+			MappedFile file;
+
+			if (!file.Open(fileName))
+			{
+				return false;
+			}
+
+			ParseBuffer(ctx, file.GetView());
+
+			return true;
+		}
+	};
+}